@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TerrainAsyncJob.h"
+#include "FastNoiseWrapper.h"
+#include "Async/Async.h"
+
+float FTerrainNoiseJob::SampleNoise(float X, float Y) const
+{
+	return Noise->GetNoise2D((X + NoiseScale) * Noise->GetFrequency(), (Y + NoiseScale) * Noise->GetFrequency());
+}
+
+void FTerrainJobTracker::Launch(const TSharedRef<FTerrainNoiseJob>& Job, TUniqueFunction<void()> Work)
+{
+	RemoveFinishedJobs();
+	Jobs.Add(Job);
+
+	Async(EAsyncExecution::ThreadPool, [Job, Work = MoveTemp(Work)]()
+	{
+		Work();
+		Job->bFinished = true;
+	});
+}
+
+void FTerrainJobTracker::CancelAll()
+{
+	for (const TSharedRef<FTerrainNoiseJob>& Job : Jobs)
+	{
+		Job->bCancelled = true;
+	}
+}
+
+bool FTerrainJobTracker::HasUnfinishedJobs()
+{
+	RemoveFinishedJobs();
+	return Jobs.Num() > 0;
+}
+
+bool FTerrainJobTracker::IsNoiseInUse(const UFastNoiseWrapper* Noise)
+{
+	RemoveFinishedJobs();
+	return Jobs.ContainsByPredicate([Noise](const TSharedRef<FTerrainNoiseJob>& Job)
+	{
+		return Job->Noise == Noise;
+	});
+}
+
+void FTerrainJobTracker::RemoveFinishedJobs()
+{
+	Jobs.RemoveAll([](const TSharedRef<FTerrainNoiseJob>& Job)
+	{
+		return Job->bFinished;
+	});
+}
+
+namespace TerrainGrid
+{
+	void BuildAxis(int32 Size, int32 Step, TArray<int32>& OutCoords)
+	{
+		OutCoords.Reset();
+		for (int32 Coord = 0; Coord < Size; Coord += Step)
+		{
+			OutCoords.Add(Coord);
+		}
+		OutCoords.Add(Size);
+	}
+}
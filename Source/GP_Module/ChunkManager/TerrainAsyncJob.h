@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UFastNoiseWrapper;
+
+/**
+ * Job de génération exécuté sur le pool de threads.
+ *
+ * Les entrées sont copiées au lancement : le job ne lit jamais l'acteur, seulement le bruit
+ * pointé par Noise. Le propriétaire garde le bruit en vie et ne le reconfigure pas tant
+ * qu'un job le lit (voir FTerrainJobTracker).
+ */
+struct GP_MODULE_API FTerrainNoiseJob
+{
+	virtual ~FTerrainNoiseJob() = default;
+
+	UFastNoiseWrapper* Noise = nullptr;
+	float NoiseScale = 0.0f;
+
+	FThreadSafeBool bCancelled;
+	FThreadSafeBool bFinished;
+
+	// Même échantillonnage que SampleNoise/CreateVertices des acteurs
+	float SampleNoise(float X, float Y) const;
+};
+
+// Jobs lancés par un acteur, terminés ou non : sert à attendre avant de reconfigurer le bruit ou de détruire l'acteur
+class GP_MODULE_API FTerrainJobTracker
+{
+public:
+	// Exécute Work sur le pool de threads ; bFinished est levé ensuite, même si le job a été annulé
+	void Launch(const TSharedRef<FTerrainNoiseJob>& Job, TUniqueFunction<void()> Work);
+
+	void CancelAll();
+	bool HasUnfinishedJobs();
+	bool IsNoiseInUse(const UFastNoiseWrapper* Noise);
+
+private:
+	TArray<TSharedRef<FTerrainNoiseJob>> Jobs;
+
+	void RemoveFinishedJobs();
+};
+
+namespace TerrainGrid
+{
+	// Coordonnées échantillonnées sur un axe pour un pas donné, bord inclus pour raccorder les grilles voisines
+	GP_MODULE_API void BuildAxis(int32 Size, int32 Step, TArray<int32>& OutCoords);
+}
@@ -2,7 +2,193 @@
 
 
 #include "TerrainChunkManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "EngineUtils.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTerrainChunk, Log, All);
+
+static FAutoConsoleCommandWithWorldAndArgs GTerrainErosionCostCommand(
+	TEXT("Terrain.ErosionCost"),
+	TEXT("Mesure le coût d'une tuile érodée. Usage : Terrain.ErosionCost [Iterations...] (défaut : 0 4 8 16 32)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		TArray<int32> IterationCounts;
+		for (const FString& Arg : Args)
+		{
+			IterationCounts.Add(FCString::Atoi(*Arg));
+		}
+		if (IterationCounts.Num() == 0)
+		{
+			IterationCounts = { 0, 4, 8, 16, 32 };
+		}
+
+		for (TActorIterator<ATerrainChunkManager> It(World); It; ++It)
+		{
+			It->ReportErosionCost(IterationCounts);
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs GTerrainRecordCommand(
+	TEXT("Terrain.Record"),
+	TEXT("Enregistre le trajet du pawn du premier joueur. Usage : Terrain.Record <Nom> pour démarrer, Terrain.Record sans argument pour arrêter et sauvegarder"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<ATerrainChunkManager> It(World); It; ++It)
+		{
+			if (Args.Num() > 0)
+			{
+				It->StartRecording(Args[0]);
+			}
+			else
+			{
+				It->StopRecording();
+			}
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs GTerrainReplayCommand(
+	TEXT("Terrain.Replay"),
+	TEXT("Rejoue un trajet enregistré et écrit un rapport. Usage : Terrain.Replay <Nom> [Vitesse] [Label]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (Args.Num() == 0)
+		{
+			return;
+		}
+
+		const float Speed = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 1.0f;
+		const FString Label = Args.Num() > 2 ? Args[2] : FString();
+		for (TActorIterator<ATerrainChunkManager> It(World); It; ++It)
+		{
+			It->StartReplay(Args[0], Speed, Label, false);
+		}
+	})
+);
+
+struct FTerrainErosionJob : public FTerrainNoiseJob
+{
+	FIntPoint ChunkCoord = FIntPoint::ZeroValue;
+	int32 ChunkSize = 0;
+	FTerrainErosionSettings Erosion;
+
+	// Résultat, lu par le game thread une fois bFinished levé
+	TArray<float> Heights;
+};
+
+#if WITH_EDITOR
+struct FTerrainChunkPreviewJob : public FTerrainNoiseJob
+{
+	FIntPoint ChunkCoord = FIntPoint::ZeroValue;
+	int32 Step = 1;  // Écart entre deux échantillons ; 0 pour remettre à l'échelle le mesh copié dans Vertices
+	int32 ChunkSize = 0;
+	float fScale = 1.0f;
+	float fUVScale = 1.0f;
+	float ZMultiplier = 1.0f;
+	float RescaleFactor = 1.0f;
+	FTerrainErosionSettings Erosion;
+
+	// Résultat, lu par le game thread une fois bFinished levé
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector2D> UVs;
+	TArray<FVector> Normals;
+	TArray<FProcMeshTangent> Tangents;
+};
+
+namespace TerrainChunkPreview
+{
+	static void BuildGrid(FTerrainChunkPreviewJob& Job)
+	{
+		// L'érosion a besoin de tous les échantillons : seulement à pleine résolution
+		TArray<float> ErodedHeights;
+		if (Job.Step == 1 && Job.Erosion.bEnabled)
+		{
+			FTerrainErosion::BuildTile(
+				Job.ChunkCoord,
+				Job.ChunkSize,
+				Job.Erosion,
+				[&Job](float X, float Y) { return Job.SampleNoise(X, Y); },
+				ErodedHeights
+			);
+		}
+
+		TArray<int32> Coords;
+		TerrainGrid::BuildAxis(Job.ChunkSize, Job.Step, Coords);
+		const int32 NumPoints = Coords.Num();
+
+		// Même disposition que GenerateOptimizedVertices/GenerateOptimizedIndices, sur la grille réduite
+		Job.Vertices.SetNumUninitialized(NumPoints * NumPoints);
+		Job.UVs.SetNumUninitialized(NumPoints * NumPoints);
+
+		const float ChunkOffsetX = Job.ChunkCoord.X * Job.ChunkSize;
+		const float ChunkOffsetY = Job.ChunkCoord.Y * Job.ChunkSize;
+
+		for (int32 IY = 0; IY < NumPoints && !Job.bCancelled; IY++)
+		{
+			for (int32 IX = 0; IX < NumPoints; IX++)
+			{
+				const int32 X = Coords[IX];
+				const int32 Y = Coords[IY];
+				const float Noise = ErodedHeights.Num() > 0
+					? ErodedHeights[X + Y * (Job.ChunkSize + 1)]
+					: Job.SampleNoise(ChunkOffsetX + X, ChunkOffsetY + Y);
+
+				Job.Vertices[IX + IY * NumPoints] = FVector(X * Job.fScale, Y * Job.fScale, Noise * Job.ZMultiplier);
+				Job.UVs[IX + IY * NumPoints] = FVector2D(X * Job.fUVScale, Y * Job.fUVScale);
+			}
+		}
+
+		Job.Triangles.Reset((NumPoints - 1) * (NumPoints - 1) * 6);
+		for (int32 IY = 0; IY < NumPoints - 1; IY++)
+		{
+			for (int32 IX = 0; IX < NumPoints - 1; IX++)
+			{
+				const int32 Vertex = IX + IY * NumPoints;
+				Job.Triangles.Add(Vertex);
+				Job.Triangles.Add(Vertex + NumPoints);
+				Job.Triangles.Add(Vertex + 1);
+				Job.Triangles.Add(Vertex + 1);
+				Job.Triangles.Add(Vertex + NumPoints);
+				Job.Triangles.Add(Vertex + NumPoints + 1);
+			}
+		}
+	}
+
+	static void Run(FTerrainChunkPreviewJob& Job)
+	{
+		if (Job.Step > 0)
+		{
+			BuildGrid(Job);
+		}
+		else
+		{
+			// Seul ZMultiplier a changé : le bruit n'est pas rééchantillonné
+			for (FVector& Vertex : Job.Vertices)
+			{
+				Vertex.Z *= Job.RescaleFactor;
+			}
+		}
+
+		if (!Job.bCancelled)
+		{
+			UKismetProceduralMeshLibrary::CalculateTangentsForMesh(Job.Vertices, Job.Triangles, Job.UVs, Job.Normals, Job.Tangents);
+		}
+	}
+}
+#endif
 
 ATerrainChunkManager::ATerrainChunkManager()
 {
@@ -15,6 +201,9 @@ ATerrainChunkManager::ATerrainChunkManager()
 
 void ATerrainChunkManager::InitializeBuffers()
 {
+	// ChunkSize peut avoir été modifié depuis le constructeur
+	MaxVerticesPerChunk = (ChunkSize + 1) * (ChunkSize + 1);
+
 	VertexBuffer.Reserve(MaxVerticesPerChunk);
 	UVBuffer.Reserve(MaxVerticesPerChunk);
 	IndexBuffer.Reserve(ChunkSize * ChunkSize * 6);  // 6 indices par quad
@@ -29,6 +218,49 @@ void ATerrainChunkManager::BeginPlay()
 
 	InitializeBuffers();
 
+	ConfigureNoise();
+
+	// Construire la fenêtre initiale en une fois, comme avant le streaming par frame
+	UpdateStreamingSources();
+	ProcessBuildQueue(0);
+	UpdateFarField();
+
+	// Rejeu sans interface (-nullrhi) : -TerrainReplay=<Nom> [-TerrainReplaySpeed=<x>] [-TerrainReplayLabel=<Label>]
+	// Le moteur avance au pas du rejeu ; -benchmark -fps=<N> est noté dans le rapport pour comparer des runs lancés pareil
+	FString ReplayTraceName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("TerrainReplay="), ReplayTraceName))
+	{
+		float Speed = 1.0f;
+		FString Label;
+		FParse::Value(FCommandLine::Get(), TEXT("TerrainReplaySpeed="), Speed);
+		FParse::Value(FCommandLine::Get(), TEXT("TerrainReplayLabel="), Label);
+		StartReplay(ReplayTraceName, Speed, Label, true);
+	}
+}
+
+void ATerrainChunkManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bRecording)
+	{
+		StopRecording();
+	}
+
+	if (bReplaying)
+	{
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(ReplayGarbageCollectHandle);
+		RestoreEngineTimeStep();
+		bReplaying = false;
+	}
+
+	// Les timers de RemoveChunk ne survivent pas à l'acteur : détruire tout de suite ce qu'ils attendaient
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	DestroyPendingChunks();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATerrainChunkManager::ConfigureNoise()
+{
 	// Configuration du générateur de bruit
 	NoiseGenerator->SetupFastNoise(
 		EFastNoise_NoiseType::Perlin,
@@ -43,70 +275,785 @@ void ATerrainChunkManager::BeginPlay()
 		EFastNoise_CellularDistanceFunction::Euclidean,
 		EFastNoise_CellularReturnType::Distance
 	);
+}
+
+void ATerrainChunkManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+#if WITH_EDITOR
+	if (!GetWorld()->IsGameWorld())
+	{
+		UpdatePreview(DeltaTime);
+		return;
+	}
+#endif
+
+	const double TickStartTime = FPlatformTime::Seconds();
+
+	if (bReplaying)
+	{
+		// Pas fixe : la suite de positions ne dépend pas de la durée réelle des frames
+		ReplayTime += ReplayFixedStep * ReplaySpeed;
+		if (FStreamingSourceState* State = StreamingSources.Find(ReplaySourceHandle))
+		{
+			State->Source.Location = ReplayTrace.Evaluate(ReplayTime);
+		}
+	}
+
+	UpdateStreamingSources();
+	const int32 ChunksBuilt = ProcessBuildQueue(MaxChunkBuildsPerTick);
+	UpdateFarField();
+
+	if (bRecording)
+	{
+		RecordFrame();
+	}
+
+	if (bReplaying)
+	{
+		const double Now = FPlatformTime::Seconds();
+		ReplayStats.AddFrame(
+			(Now - TickStartTime) * 1000.0,
+			(Now - ReplayLastFrameTime) * 1000.0,
+			ChunksBuilt,
+			ActiveChunks.Num() + ChunksPendingDestroy.Num()
+		);
+		ReplayLastFrameTime = Now;
+
+		if (ReplayTime >= ReplayTrace.GetDuration())
+		{
+			FinishReplay();
+		}
+	}
+}
+
+bool ATerrainChunkManager::ShouldTickIfViewportsOnly() const
+{
+#if WITH_EDITOR
+	// Hors Play, les jobs de preview sont lancés et appliqués depuis le Tick des viewports
+	if (bEditorPreview && GetWorld() && !GetWorld()->IsGameWorld())
+	{
+		return true;
+	}
+#endif
+	return Super::ShouldTickIfViewportsOnly();
+}
+
+#if WITH_EDITOR
+void ATerrainChunkManager::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	if (bEditorPreview && PreviewSourceHandle == INDEX_NONE && GetWorld() && !GetWorld()->IsGameWorld())
+	{
+		RequestPreview(true);
+	}
+}
+
+void ATerrainChunkManager::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (GetWorld() && GetWorld()->IsGameWorld())
+	{
+		return;
+	}
+
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, Material))
+	{
+		for (auto& Pair : ActiveChunks)
+		{
+			Pair.Value->SetMaterial(0, Material);
+		}
+		if (FarFieldMesh)
+		{
+			FarFieldMesh->SetMaterial(0, Material);
+		}
+		return;
+	}
+
+	// L'anneau lointain se met à jour seul, sans reconstruire les chunks
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, bFarField)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, FarFieldDistance)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, FarFieldCellsPerChunk)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, FarFieldSink))
+	{
+		bFarFieldDirty = true;
+		return;
+	}
+
+	if (!bEditorPreview)
+	{
+		StopPreview();
+		return;
+	}
+
+	// Propriétés dont dépend le contenu des chunks : bruit, grille, érosion. NAME_None couvre l'annulation
+	// et le reset, qui ne disent pas ce qui a changé.
+	const bool bAffectsChunks = PropertyName == NAME_None
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, bEditorPreview)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, ChunkSize)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, fScale)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, fUVScale)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, NoiseScale)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, Seed)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, Frequency)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, Erosion);
+
+	if (bAffectsChunks)
+	{
+		RequestPreview(true);
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, ZMultiplier)
+		|| PropertyName == GET_MEMBER_NAME_CHECKED(ATerrainChunkManager, RenderDistance))
+	{
+		// ZMultiplier : remise à l'échelle des chunks affichés ; RenderDistance : seule la différence
+		// de fenêtre est construite ou retirée par UpdateStreamingSources
+		RequestPreview(false);
+	}
+
+	// Les autres propriétés (budgets, cache, benchmark, sources) sont relues à l'usage : rien à reconstruire
+}
+
+void ATerrainChunkManager::RequestPreview(bool bRebuild)
+{
+	bPreviewNeedsRebuild |= bRebuild || PreviewSourceHandle == INDEX_NONE;
+	bPreviewPending = true;
+	PreviewDebounceRemaining = PreviewDebounceSeconds;
+}
+
+void ATerrainChunkManager::UpdatePreview(float DeltaTime)
+{
+	if (bPreviewPending)
+	{
+		// Rien n'est lancé pendant l'attente : les jobs prennent PreviewAppliedZMultiplier
+		PreviewDebounceRemaining -= DeltaTime;
+		if (PreviewDebounceRemaining > 0.0f)
+		{
+			return;
+		}
+
+		if (bPreviewNeedsRebuild || PreviewAppliedZMultiplier == 0.0f)
+		{
+			// Le bruit va être reconfiguré : attendre que plus aucun job ne le lise
+			CancelPreviewJobs();
+			if (NoiseJobs.HasUnfinishedJobs())
+			{
+				return;
+			}
+
+			ClearChunks();
+			InitializeBuffers();
+			ConfigureNoise();
+
+			if (PreviewSourceHandle == INDEX_NONE)
+			{
+				FTerrainStreamingSource Source;
+				Source.Actor = this;
+				PreviewSourceHandle = RegisterStreamingSource(Source);
+			}
+		}
+		else if (ZMultiplier != PreviewAppliedZMultiplier)
+		{
+			// Les chunks sont remis à l'échelle par SchedulePreviewJobs, au fil des frames
+			bFarFieldDirty = true;
+		}
+
+		bPreviewPending = false;
+		bPreviewNeedsRebuild = false;
+		PreviewAppliedZMultiplier = ZMultiplier;
+	}
+
+	UpdateStreamingSources();
+
+	// Les chunks sortis de la fenêtre n'ont plus besoin de leur job
+	for (auto It = PreviewJobs.CreateIterator(); It; ++It)
+	{
+		if (!ChunkReferences.Contains(It->Key))
+		{
+			It->Value->bCancelled = true;
+			It.RemoveCurrent();
+		}
+	}
+
+	ApplyPreviewResults();
+	SchedulePreviewJobs();
+	UpdateFarField();
+}
+
+void ATerrainChunkManager::SchedulePreviewJobs()
+{
+	const int32 MaxJobs = MaxChunkBuildsPerTick > 0 ? MaxChunkBuildsPerTick : MAX_int32;
+
+	// Passe grossière sur toute la fenêtre d'abord, les chunks les plus proches en premier
+	while (BuildQueue.Num() > 0 && PreviewJobs.Num() < MaxJobs)
+	{
+		FChunkBuildRequest Request;
+		BuildQueue.HeapPop(Request);
+
+		const float* PendingPriority = PendingBuilds.Find(Request.ChunkCoord);
+		if (!PendingPriority || *PendingPriority != Request.Priority)
+		{
+			continue;
+		}
 
-	UpdateChunks();
+		PendingBuilds.Remove(Request.ChunkCoord);
+		if (!PreviewJobs.Contains(Request.ChunkCoord))
+		{
+			LaunchPreviewJob(Request.ChunkCoord, FMath::Clamp(PreviewCoarseStep, 1, ChunkSize));
+		}
+	}
+
+	if (BuildQueue.Num() > 0 || PreviewJobs.Num() >= MaxJobs)
+	{
+		return;
+	}
+
+	// Puis raffinement à pleine résolution et remise à l'échelle des chunks déjà affichés
+	TArray<TPair<float, FIntPoint>> Candidates;
+	for (const auto& Pair : ActiveChunks)
+	{
+		const FPreviewChunkState* State = PreviewChunkStates.Find(Pair.Key);
+		if (PreviewJobs.Contains(Pair.Key) || (State && State->Step == 1 && State->ZMultiplier == PreviewAppliedZMultiplier))
+		{
+			continue;
+		}
+		Candidates.Emplace(GetBuildPriority(Pair.Key), Pair.Key);
+	}
+
+	Candidates.Sort([](const TPair<float, FIntPoint>& A, const TPair<float, FIntPoint>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	for (const TPair<float, FIntPoint>& Candidate : Candidates)
+	{
+		if (PreviewJobs.Num() >= MaxJobs)
+		{
+			break;
+		}
+
+		const FPreviewChunkState* State = PreviewChunkStates.Find(Candidate.Value);
+		const bool bCanRescale = State && State->Step == 1 && State->ZMultiplier != 0.0f;
+		LaunchPreviewJob(Candidate.Value, bCanRescale ? 0 : 1);
+	}
+}
+
+void ATerrainChunkManager::LaunchPreviewJob(const FIntPoint& ChunkCoord, int32 Step)
+{
+	TSharedPtr<FTerrainChunkPreviewJob> Job = MakeShared<FTerrainChunkPreviewJob>();
+	Job->ChunkCoord = ChunkCoord;
+	Job->Step = Step;
+	Job->ChunkSize = ChunkSize;
+	Job->fScale = fScale;
+	Job->fUVScale = fUVScale;
+	Job->ZMultiplier = PreviewAppliedZMultiplier;
+	Job->NoiseScale = NoiseScale;
+	Job->Erosion = Erosion;
+	Job->Noise = NoiseGenerator;
+
+	if (Step == 0)
+	{
+		// Copie du mesh affiché ; la mise à l'échelle et les tangentes se font sur le worker
+		const FProcMeshSection* Section = ActiveChunks[ChunkCoord]->GetProcMeshSection(0);
+		if (!Section)
+		{
+			Job->Step = 1;
+		}
+		else
+		{
+			Job->RescaleFactor = PreviewAppliedZMultiplier / PreviewChunkStates[ChunkCoord].ZMultiplier;
+			Job->Vertices.Reserve(Section->ProcVertexBuffer.Num());
+			Job->UVs.Reserve(Section->ProcVertexBuffer.Num());
+			for (const FProcMeshVertex& Vertex : Section->ProcVertexBuffer)
+			{
+				Job->Vertices.Add(Vertex.Position);
+				Job->UVs.Add(Vertex.UV0);
+			}
+
+			Job->Triangles.Reserve(Section->ProcIndexBuffer.Num());
+			for (uint32 Index : Section->ProcIndexBuffer)
+			{
+				Job->Triangles.Add(static_cast<int32>(Index));
+			}
+		}
+	}
+
+	PreviewJobs.Add(ChunkCoord, Job);
+
+	NoiseJobs.Launch(Job.ToSharedRef(), [Job]()
+	{
+		TerrainChunkPreview::Run(*Job);
+	});
+}
+
+void ATerrainChunkManager::ApplyPreviewResults()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	for (auto It = PreviewJobs.CreateIterator(); It; ++It)
+	{
+		// Le reste attend la frame suivante
+		if ((FPlatformTime::Seconds() - StartTime) * 1000.0 >= PreviewApplyBudgetMs)
+		{
+			break;
+		}
+
+		FTerrainChunkPreviewJob& Job = *It->Value;
+		if (!Job.bFinished)
+		{
+			continue;
+		}
+
+		const FIntPoint ChunkCoord = It->Key;
+		UProceduralMeshComponent* Chunk = ActiveChunks.FindRef(ChunkCoord);
+
+		if (Job.Step == 0)
+		{
+			if (Chunk)
+			{
+				Chunk->UpdateMeshSection(0, Job.Vertices, Job.Normals, Job.UVs, TArray<FColor>(), Job.Tangents);
+				PreviewChunkStates.FindOrAdd(ChunkCoord).ZMultiplier = Job.ZMultiplier;
+			}
+		}
+		else
+		{
+			if (!Chunk)
+			{
+				Chunk = AddChunkComponent(ChunkCoord);
+				Chunk->SetMaterial(0, Material);
+			}
+
+			// Sans collision : sa cuisson bloquerait le game thread pour un mesh vite remplacé
+			Chunk->CreateMeshSection(0, Job.Vertices, Job.Triangles, Job.Normals, Job.UVs, TArray<FColor>(), Job.Tangents, false);
+			PreviewChunkStates.Add(ChunkCoord, FPreviewChunkState{ Job.Step, Job.ZMultiplier });
+		}
+
+		It.RemoveCurrent();
+	}
+}
+
+void ATerrainChunkManager::CancelPreviewJobs()
+{
+	// Les jobs annulés restent dans NoiseJobs jusqu'à ce qu'ils ne lisent plus le bruit
+	for (auto& Pair : PreviewJobs)
+	{
+		Pair.Value->bCancelled = true;
+	}
+	PreviewJobs.Empty();
+}
+
+void ATerrainChunkManager::StopPreview()
+{
+	bPreviewPending = false;
+	bPreviewNeedsRebuild = false;
+
+	if (PreviewSourceHandle != INDEX_NONE)
+	{
+		UnregisterStreamingSource(PreviewSourceHandle);
+		PreviewSourceHandle = INDEX_NONE;
+	}
+	ClearChunks();
+}
+#endif
+
+void ATerrainChunkManager::BeginDestroy()
+{
+	NoiseJobs.CancelAll();
+
+	Super::BeginDestroy();
+}
+
+bool ATerrainChunkManager::IsReadyForFinishDestroy()
+{
+	return !NoiseJobs.HasUnfinishedJobs() && Super::IsReadyForFinishDestroy();
+}
+
+int32 ATerrainChunkManager::RegisterStreamingSource(const FTerrainStreamingSource& Source)
+{
+	const int32 Handle = NextStreamingSourceHandle++;
+
+	FStreamingSourceState& State = StreamingSources.Add(Handle);
+	State.Source = Source;
+	State.bTracksActor = Source.Actor.IsValid();
+
+	return Handle;
+}
+
+void ATerrainChunkManager::UpdateStreamingSource(int32 Handle, const FTerrainStreamingSource& Source)
+{
+	if (FStreamingSourceState* State = StreamingSources.Find(Handle))
+	{
+		// La nouvelle fenêtre sera appliquée au prochain UpdateStreamingSources
+		State->Source = Source;
+		State->bTracksActor = Source.Actor.IsValid();
+	}
+}
+
+void ATerrainChunkManager::UnregisterStreamingSource(int32 Handle)
+{
+	FStreamingSourceState State;
+	if (StreamingSources.RemoveAndCopyValue(Handle, State))
+	{
+		ApplySourceWindow(State, State.AppliedCenter, -1);
+	}
+}
+
+void ATerrainChunkManager::RegisterPlayerControllers()
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && !PlayerSourceHandles.Contains(PC))
+		{
+			FTerrainStreamingSource Source;
+			Source.Actor = PC;
+			PlayerSourceHandles.Add(PC, RegisterStreamingSource(Source));
+		}
+	}
+
+	// Les contrôleurs détruits perdent leur source dans UpdateStreamingSources
+	for (auto It = PlayerSourceHandles.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool ATerrainChunkManager::ResolveSourceLocation(const FTerrainStreamingSource& Source, FVector& OutLocation) const
+{
+	AActor* Actor = Source.Actor.Get();
+	if (!Actor)
+	{
+		OutLocation = Source.Location;
+		return true;
+	}
+
+	if (APlayerController* PC = Cast<APlayerController>(Actor))
+	{
+		// Pawn, sinon spectateur, sinon caméra (cinématique, mort...)
+		if (APawn* Pawn = PC->GetPawnOrSpectator())
+		{
+			OutLocation = Pawn->GetActorLocation();
+			return true;
+		}
+		if (PC->PlayerCameraManager)
+		{
+			OutLocation = PC->PlayerCameraManager->GetCameraLocation();
+			return true;
+		}
+		return false;
+	}
+
+	OutLocation = Actor->GetActorLocation();
+	return true;
+}
+
+void ATerrainChunkManager::UpdateStreamingSources()
+{
+	if (bAutoRegisterPlayerControllers)
+	{
+		RegisterPlayerControllers();
+	}
+
+	TArray<int32> StaleSources;
+	bool bWindowsChanged = false;
+	for (auto& Pair : StreamingSources)
+	{
+		FStreamingSourceState& State = Pair.Value;
+		if (State.bTracksActor && !State.Source.Actor.IsValid())
+		{
+			StaleSources.Add(Pair.Key);
+			continue;
+		}
+
+		// Sans position connue (pas de pawn ni de caméra), on garde la fenêtre actuelle
+		FVector Location;
+		if (!ResolveSourceLocation(State.Source, Location))
+		{
+			continue;
+		}
+
+		const int32 Radius = State.Source.RenderDistance >= 0 ? State.Source.RenderDistance : RenderDistance;
+		const FIntPoint Center = WorldToChunkCoord(Location);
+		if (Center != State.AppliedCenter || Radius != State.AppliedRadius)
+		{
+			ApplySourceWindow(State, Center, Radius);
+			bWindowsChanged = true;
+		}
+	}
+
+	for (int32 Handle : StaleSources)
+	{
+		UnregisterStreamingSource(Handle);
+		bWindowsChanged = true;
+	}
+
+	// Les chunks en attente se rapprochent ou s'éloignent des sources qui ont bougé
+	if (bWindowsChanged && PendingBuilds.Num() > 0)
+	{
+		RefreshBuildPriorities();
+	}
+}
+
+void ATerrainChunkManager::ApplySourceWindow(FStreamingSourceState& State, const FIntPoint& NewCenter, int32 NewRadius)
+{
+	const FIntPoint OldCenter = State.AppliedCenter;
+	const int32 OldRadius = State.AppliedRadius;
+
+	// Parcourt les chunks de la fenêtre A absents de la fenêtre B, ligne par ligne :
+	// le coût suit la zone qui change, pas la surface totale de la fenêtre
+	auto ForEachInDifference = [](const FIntPoint& CenterA, int32 RadiusA, const FIntPoint& CenterB, int32 RadiusB, auto&& Func)
+	{
+		if (RadiusA < 0)
+		{
+			return;
+		}
+
+		for (int32 Y = CenterA.Y - RadiusA; Y <= CenterA.Y + RadiusA; Y++)
+		{
+			const int32 MinX = CenterA.X - RadiusA;
+			const int32 MaxX = CenterA.X + RadiusA;
+
+			if (RadiusB < 0 || FMath::Abs(Y - CenterB.Y) > RadiusB)
+			{
+				for (int32 X = MinX; X <= MaxX; X++)
+				{
+					Func(FIntPoint(X, Y));
+				}
+				continue;
+			}
+
+			for (int32 X = MinX; X <= FMath::Min(MaxX, CenterB.X - RadiusB - 1); X++)
+			{
+				Func(FIntPoint(X, Y));
+			}
+			for (int32 X = FMath::Max(MinX, CenterB.X + RadiusB + 1); X <= MaxX; X++)
+			{
+				Func(FIntPoint(X, Y));
+			}
+		}
+	};
+
+	const float Weight = FMath::Max(State.Source.Priority, 0.01f);
+	ForEachInDifference(NewCenter, NewRadius, OldCenter, OldRadius, [this, &NewCenter, Weight](const FIntPoint& ChunkCoord)
+	{
+		const int32 Distance = FMath::Max(FMath::Abs(ChunkCoord.X - NewCenter.X), FMath::Abs(ChunkCoord.Y - NewCenter.Y));
+		AddChunkReference(ChunkCoord, Distance / Weight);
+	});
+	ForEachInDifference(OldCenter, OldRadius, NewCenter, NewRadius, [this](const FIntPoint& ChunkCoord)
+	{
+		ReleaseChunkReference(ChunkCoord);
+	});
+
+	State.AppliedCenter = NewCenter;
+	State.AppliedRadius = NewRadius;
+}
+
+void ATerrainChunkManager::AddChunkReference(const FIntPoint& ChunkCoord, float BuildPriority)
+{
+	int32& References = ChunkReferences.FindOrAdd(ChunkCoord, 0);
+	References++;
+
+	if (ActiveChunks.Contains(ChunkCoord))
+	{
+		return;
+	}
+
+	// Un chunk couvert par plusieurs sources n'est construit qu'une fois, avec la meilleure priorité
+	float* PendingPriority = PendingBuilds.Find(ChunkCoord);
+	if (PendingPriority && *PendingPriority <= BuildPriority)
+	{
+		return;
+	}
+
+	PendingBuilds.Add(ChunkCoord, BuildPriority);
+	BuildQueue.HeapPush(FChunkBuildRequest{ ChunkCoord, BuildPriority });
+}
+
+void ATerrainChunkManager::ReleaseChunkReference(const FIntPoint& ChunkCoord)
+{
+	int32* References = ChunkReferences.Find(ChunkCoord);
+	if (!References || --(*References) > 0)
+	{
+		return;
+	}
+
+	ChunkReferences.Remove(ChunkCoord);
+
+	// Les entrées du tas deviennent périmées et sont ignorées au dépilement
+	PendingBuilds.Remove(ChunkCoord);
+
+	if (ActiveChunks.Contains(ChunkCoord))
+	{
+		RemoveChunk(ChunkCoord);
+	}
 }
 
-void ATerrainChunkManager::Tick(float DeltaTime)
+float ATerrainChunkManager::GetBuildPriority(const FIntPoint& ChunkCoord) const
 {
-	Super::Tick(DeltaTime);
-
-	APlayerController* PC = UGameplayStatics::GetPlayerController(this, 0);
-	if (!PC) return;
+	// Distance pondérée à la plus proche des sources dont la fenêtre couvre le chunk
+	float BestPriority = MAX_flt;
+	for (const auto& Pair : StreamingSources)
+	{
+		const FStreamingSourceState& State = Pair.Value;
+		const int32 Distance = FMath::Max(FMath::Abs(ChunkCoord.X - State.AppliedCenter.X), FMath::Abs(ChunkCoord.Y - State.AppliedCenter.Y));
+		if (State.AppliedRadius < 0 || Distance > State.AppliedRadius)
+		{
+			continue;
+		}
 
-	FVector PlayerLocation = PC->GetPawn()->GetActorLocation();
-	FIntPoint NewPlayerChunk = WorldToChunkCoord(PlayerLocation);
+		BestPriority = FMath::Min(BestPriority, Distance / FMath::Max(State.Source.Priority, 0.01f));
+	}
+	return BestPriority;
+}
 
-	if (NewPlayerChunk != CurrentPlayerChunk)
+void ATerrainChunkManager::RefreshBuildPriorities()
+{
+	// Reconstruire le tas purge aussi les entrées périmées laissées par ReleaseChunkReference
+	BuildQueue.Reset(PendingBuilds.Num());
+	for (auto& Pair : PendingBuilds)
 	{
-		CurrentPlayerChunk = NewPlayerChunk;
-		UpdateChunks();
+		Pair.Value = GetBuildPriority(Pair.Key);
+		BuildQueue.Add(FChunkBuildRequest{ Pair.Key, Pair.Value });
 	}
+	BuildQueue.Heapify();
 }
 
-void ATerrainChunkManager::UpdateChunks()
+int32 ATerrainChunkManager::ProcessBuildQueue(int32 MaxBuilds)
 {
-	TSet<FIntPoint> ChunksToKeep;
-    
-	for (int32 X = -RenderDistance; X <= RenderDistance; X++)
+	// Sans limite par frame (chargement initial), l'érosion se fait d'un bloc en parallèle
+	const bool bErodeInBackground = Erosion.bEnabled && MaxBuilds > 0;
+	if (bErodeInBackground)
+	{
+		CollectErosionJobs();
+	}
+
+	TArray<FIntPoint> ChunksToCreate;
+
+	while (BuildQueue.Num() > 0 && (MaxBuilds <= 0 || ChunksToCreate.Num() < MaxBuilds))
 	{
-		for (int32 Y = -RenderDistance; Y <= RenderDistance; Y++)
+		FChunkBuildRequest Request;
+		BuildQueue.HeapPop(Request);
+
+		const float* PendingPriority = PendingBuilds.Find(Request.ChunkCoord);
+		if (!PendingPriority || *PendingPriority != Request.Priority)
 		{
-			FIntPoint ChunkCoord(
-				CurrentPlayerChunk.X + X,
-				CurrentPlayerChunk.Y + Y
-			);
-            
-			if (IsChunkInRange(ChunkCoord))
+			continue;
+		}
+
+		// Un chunk sans tuile érodée attend son job ; il reviendra dans la file quand la tuile sera prête
+		if (bErodeInBackground && !ErodedTileCache.Contains(Request.ChunkCoord))
+		{
+			if (!ErosionJobs.Contains(Request.ChunkCoord))
 			{
-				ChunksToKeep.Add(ChunkCoord);
-				if (!ActiveChunks.Contains(ChunkCoord))
+				if (ErosionJobs.Num() >= MaxBuilds)
 				{
-					CreateChunk(ChunkCoord);
+					BuildQueue.HeapPush(Request);
+					break;
 				}
+				LaunchErosionJob(Request.ChunkCoord);
 			}
+			PendingBuilds.Remove(Request.ChunkCoord);
+			continue;
 		}
+
+		PendingBuilds.Remove(Request.ChunkCoord);
+		ChunksToCreate.Add(Request.ChunkCoord);
 	}
 
-	TArray<FIntPoint> ChunksToRemove;
-	for (auto& Pair : ActiveChunks)
+	if (ChunksToCreate.Num() == 0)
+	{
+		return 0;
+	}
+
+	// L'érosion des nouveaux chunks se fait en parallèle avant la création des meshes
+	if (Erosion.bEnabled && !bErodeInBackground)
+	{
+		BuildErodedTiles(ChunksToCreate);
+	}
+
+	for (const FIntPoint& ChunkCoord : ChunksToCreate)
+	{
+		CreateChunk(ChunkCoord);
+	}
+
+	TrimErodedTileCache();
+
+	return ChunksToCreate.Num();
+}
+
+void ATerrainChunkManager::LaunchErosionJob(const FIntPoint& ChunkCoord)
+{
+	TSharedPtr<FTerrainErosionJob> Job = MakeShared<FTerrainErosionJob>();
+	Job->ChunkCoord = ChunkCoord;
+	Job->ChunkSize = ChunkSize;
+	Job->Erosion = Erosion;
+	Job->Noise = NoiseGenerator;
+	Job->NoiseScale = NoiseScale;
+
+	ErosionJobs.Add(ChunkCoord, Job);
+
+	NoiseJobs.Launch(Job.ToSharedRef(), [Job]()
+	{
+		FTerrainErosion::BuildTile(
+			Job->ChunkCoord,
+			Job->ChunkSize,
+			Job->Erosion,
+			[&Job](float X, float Y) { return Job->SampleNoise(X, Y); },
+			Job->Heights
+		);
+	});
+}
+
+void ATerrainChunkManager::CollectErosionJobs()
+{
+	for (auto It = ErosionJobs.CreateIterator(); It; ++It)
 	{
-		if (!ChunksToKeep.Contains(Pair.Key))
+		FTerrainErosionJob& Job = *It->Value;
+		if (!Job.bFinished)
+		{
+			continue;
+		}
+
+		// La tuile est gardée même si le chunk est sorti de la fenêtre entre-temps : il peut revenir
+		const FIntPoint ChunkCoord = It->Key;
+		ErodedTileCache.Add(ChunkCoord, MoveTemp(Job.Heights));
+		It.RemoveCurrent();
+
+		if (ChunkReferences.Contains(ChunkCoord) && !ActiveChunks.Contains(ChunkCoord) && !PendingBuilds.Contains(ChunkCoord))
 		{
-			ChunksToRemove.Add(Pair.Key);
+			const float Priority = GetBuildPriority(ChunkCoord);
+			PendingBuilds.Add(ChunkCoord, Priority);
+			BuildQueue.HeapPush(FChunkBuildRequest{ ChunkCoord, Priority });
 		}
 	}
+}
 
-	for (const FIntPoint& ChunkCoord : ChunksToRemove)
+int32 ATerrainChunkManager::GetDistanceToNearestSource(const FIntPoint& ChunkCoord) const
+{
+	int32 BestDistance = MAX_int32;
+	for (const auto& Pair : StreamingSources)
 	{
-		RemoveChunk(ChunkCoord);
+		if (Pair.Value.AppliedRadius < 0)
+		{
+			continue;
+		}
+
+		const FIntPoint& Center = Pair.Value.AppliedCenter;
+		const int32 Distance = FMath::Max(FMath::Abs(ChunkCoord.X - Center.X), FMath::Abs(ChunkCoord.Y - Center.Y));
+		BestDistance = FMath::Min(BestDistance, Distance);
 	}
+	return BestDistance;
 }
 
 void ATerrainChunkManager::CreateChunk(const FIntPoint& ChunkCoord)
 {
-	UProceduralMeshComponent* Chunk = NewObject<UProceduralMeshComponent>(this);
-	Chunk->RegisterComponent();
+	UProceduralMeshComponent* Chunk = AddChunkComponent(ChunkCoord);
     
 	// Utiliser les buffers préalloués
 	GenerateOptimizedVertices(ChunkCoord, VertexBuffer, UVBuffer);
@@ -137,6 +1084,16 @@ void ATerrainChunkManager::CreateChunk(const FIntPoint& ChunkCoord)
     
 	Chunk->SetMaterial(0, Material);
     
+	// Vider le cache de bruit après la création du chunk
+	ClearNoiseCache();
+}
+
+UProceduralMeshComponent* ATerrainChunkManager::AddChunkComponent(const FIntPoint& ChunkCoord)
+{
+	// Transient : les chunks de la preview ne doivent pas être sauvegardés ni copiés en PIE
+	UProceduralMeshComponent* Chunk = NewObject<UProceduralMeshComponent>(this, NAME_None, RF_Transient | RF_DuplicateTransient);
+	Chunk->RegisterComponent();
+
 	// Positionner le chunk
 	Chunk->SetRelativeLocation(
 		FVector(
@@ -145,38 +1102,84 @@ void ATerrainChunkManager::CreateChunk(const FIntPoint& ChunkCoord)
 			0
 		)
 	);
-    
+
 	ActiveChunks.Add(ChunkCoord, Chunk);
-    
-	// Vider le cache de bruit après la création du chunk
+	bFarFieldDirty = true;
+	return Chunk;
+}
+
+void ATerrainChunkManager::ClearChunks()
+{
+#if WITH_EDITOR
+	CancelPreviewJobs();
+	PreviewChunkStates.Empty();
+#endif
+
+	// Les tuiles en cours seraient rangées dans un cache vidé : NoiseJobs les suit jusqu'à leur fin
+	for (auto& Pair : ErosionJobs)
+	{
+		Pair.Value->bCancelled = true;
+	}
+	ErosionJobs.Empty();
+
+	for (auto& Pair : ActiveChunks)
+	{
+		Pair.Value->DestroyComponent();
+	}
+	ActiveChunks.Empty();
+	ChunkReferences.Empty();
+	PendingBuilds.Empty();
+	BuildQueue.Empty();
+	ErodedTileCache.Empty();
 	ClearNoiseCache();
+	ClearFarField();
+
+	// Les fenêtres seront réappliquées entièrement au prochain UpdateStreamingSources
+	for (auto& Pair : StreamingSources)
+	{
+		Pair.Value.AppliedRadius = -1;
+	}
 }
 
 void ATerrainChunkManager::RemoveChunk(const FIntPoint& ChunkCoord)
 {
 	if (UProceduralMeshComponent* Chunk = ActiveChunks[ChunkCoord])
 	{
-		// Attendre quelques frames avant de détruire le chunk
+		// Attendre quelques frames avant de détruire le chunk. Le timer est lié à l'acteur : il est annulé
+		// avec lui, et EndPlay détruit les chunks qu'il n'a pas encore traités
 		FTimerHandle UnusedHandle;
 		GetWorld()->GetTimerManager().SetTimer(
 			UnusedHandle,
-			[this, Chunk]()
+			FTimerDelegate::CreateWeakLambda(this, [this, Chunk]()
 			{
-				Chunk->DestroyComponent();
-			},
+				if (ChunksPendingDestroy.RemoveSingleSwap(Chunk) > 0 && IsValid(Chunk))
+				{
+					Chunk->DestroyComponent();
+				}
+			}),
 			0.5f,  // Délai de 0.5 secondes
 			false
 		);
 		ActiveChunks.Remove(ChunkCoord);
+		ChunksPendingDestroy.Add(Chunk);
+		bFarFieldDirty = true;
+
+#if WITH_EDITORONLY_DATA
+		PreviewChunkStates.Remove(ChunkCoord);
+#endif
 	}
 }
 
-bool ATerrainChunkManager::IsChunkInRange(const FIntPoint& ChunkCoord)
+void ATerrainChunkManager::DestroyPendingChunks()
 {
-	int32 DistanceX = FMath::Abs(ChunkCoord.X - CurrentPlayerChunk.X);
-	int32 DistanceY = FMath::Abs(ChunkCoord.Y - CurrentPlayerChunk.Y);
-	// Ajouter une marge de 1 chunk pour éviter les trous
-	return FMath::Max(DistanceX, DistanceY) <= (RenderDistance + 1);
+	for (UProceduralMeshComponent* Chunk : ChunksPendingDestroy)
+	{
+		if (IsValid(Chunk))
+		{
+			Chunk->DestroyComponent();
+		}
+	}
+	ChunksPendingDestroy.Empty();
 }
 
 FIntPoint ATerrainChunkManager::WorldToChunkCoord(const FVector& WorldLocation)
@@ -197,15 +1200,21 @@ float ATerrainChunkManager::GetCachedNoise(float X, float Y)
 		return *CachedValue;
 	}
     
-	float NoiseValue = NoiseGenerator->GetNoise2D(
-		(X + NoiseScale) * NoiseGenerator->GetFrequency(),
-		(Y + NoiseScale) * NoiseGenerator->GetFrequency()
-	);
+	float NoiseValue = SampleNoise(X, Y);
     
 	NoiseCache.Add(NoiseKey, NoiseValue);
 	return NoiseValue;
 }
 
+float ATerrainChunkManager::SampleNoise(float X, float Y) const
+{
+	// Pas de cache ici : appelé depuis plusieurs threads pendant l'érosion
+	return NoiseGenerator->GetNoise2D(
+		(X + NoiseScale) * NoiseGenerator->GetFrequency(),
+		(Y + NoiseScale) * NoiseGenerator->GetFrequency()
+	);
+}
+
 void ATerrainChunkManager::GenerateOptimizedVertices(const FIntPoint& ChunkCoord, TArray<FVector>& OutVertices, TArray<FVector2D>& OutUVs)
 {
 	OutVertices.Reset(MaxVerticesPerChunk);
@@ -218,6 +1227,9 @@ void ATerrainChunkManager::GenerateOptimizedVertices(const FIntPoint& ChunkCoord
 	// Calculer les offsets du chunk
 	const float ChunkOffsetX = ChunkCoord.X * ChunkSize;
 	const float ChunkOffsetY = ChunkCoord.Y * ChunkSize;
+
+	// Hauteurs érodées si la tuile a été construite, bruit brut sinon
+	const TArray<float>* ErodedHeights = Erosion.bEnabled ? ErodedTileCache.Find(ChunkCoord) : nullptr;
     
 	// Optimisation SIMD pour le traitement par lots
 	for (int32 Y = 0; Y <= ChunkSize; Y += 4)
@@ -236,7 +1248,7 @@ void ATerrainChunkManager::GenerateOptimizedVertices(const FIntPoint& ChunkCoord
 					const float WorldX = ChunkOffsetX + CurrentX;
 					const float WorldY = ChunkOffsetY + CurrentY;
                     
-					const float Height = GetCachedNoise(WorldX, WorldY) * ZMultiplier;
+					const float Height = (ErodedHeights ? (*ErodedHeights)[Index] : GetCachedNoise(WorldX, WorldY)) * ZMultiplier;
                     
 					OutVertices[Index] = FVector(CurrentX * fScale, CurrentY * fScale, Height);
 					OutUVs[Index] = FVector2D(CurrentX * fUVScale, CurrentY * fUVScale);
@@ -278,4 +1290,408 @@ void ATerrainChunkManager::GenerateOptimizedIndices(TArray<int32>& OutIndices)
 void ATerrainChunkManager::ClearNoiseCache()
 {
 	NoiseCache.Empty();
+}
+
+void ATerrainChunkManager::BuildErodedTiles(const TArray<FIntPoint>& ChunkCoords)
+{
+	TArray<FIntPoint> MissingTiles;
+	for (const FIntPoint& ChunkCoord : ChunkCoords)
+	{
+		if (!ErodedTileCache.Contains(ChunkCoord))
+		{
+			MissingTiles.Add(ChunkCoord);
+		}
+	}
+
+	if (MissingTiles.Num() == 0)
+	{
+		return;
+	}
+
+	// Chaque tuile ne dépend que de ses coordonnées : l'ordre et le nombre de threads n'ont pas d'effet
+	TArray<TArray<float>> Tiles;
+	Tiles.SetNum(MissingTiles.Num());
+
+	const double StartTime = FPlatformTime::Seconds();
+	ParallelFor(MissingTiles.Num(), [this, &MissingTiles, &Tiles](int32 TileIndex)
+	{
+		FTerrainErosion::BuildTile(
+			MissingTiles[TileIndex],
+			ChunkSize,
+			Erosion,
+			[this](float X, float Y) { return SampleNoise(X, Y); },
+			Tiles[TileIndex]
+		);
+	});
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	for (int32 TileIndex = 0; TileIndex < MissingTiles.Num(); TileIndex++)
+	{
+		ErodedTileCache.Add(MissingTiles[TileIndex], MoveTemp(Tiles[TileIndex]));
+	}
+
+	UE_LOG(LogTerrainChunk, Verbose, TEXT("Erosion : %d tuiles en %.2f ms (%d itérations, halo %d)"),
+		MissingTiles.Num(), ElapsedMs, Erosion.Iterations, Erosion.GetHaloSize());
+}
+
+void ATerrainChunkManager::TrimErodedTileCache()
+{
+	if (ErodedTileCache.Num() <= MaxCachedErodedTiles)
+	{
+		return;
+	}
+
+	// Évincer d'abord les tuiles inactives les plus éloignées des sources ; celles qui attendent leur
+	// construction dans la file sont gardées, sinon leur chunk relancerait l'érosion
+	TArray<FIntPoint> Candidates;
+	for (const auto& Pair : ErodedTileCache)
+	{
+		if (!ActiveChunks.Contains(Pair.Key) && !PendingBuilds.Contains(Pair.Key))
+		{
+			Candidates.Add(Pair.Key);
+		}
+	}
+
+	TMap<FIntPoint, int32> Distances;
+	for (const FIntPoint& ChunkCoord : Candidates)
+	{
+		Distances.Add(ChunkCoord, GetDistanceToNearestSource(ChunkCoord));
+	}
+
+	Candidates.Sort([&Distances](const FIntPoint& A, const FIntPoint& B)
+	{
+		return Distances[A] > Distances[B];
+	});
+
+	for (const FIntPoint& ChunkCoord : Candidates)
+	{
+		if (ErodedTileCache.Num() <= MaxCachedErodedTiles)
+		{
+			break;
+		}
+		ErodedTileCache.Remove(ChunkCoord);
+	}
+}
+
+void ATerrainChunkManager::ReportErosionCost(const TArray<int32>& IterationCounts)
+{
+	FIntPoint ChunkCoord = FIntPoint::ZeroValue;
+	for (const auto& Pair : StreamingSources)
+	{
+		if (Pair.Value.AppliedRadius >= 0)
+		{
+			ChunkCoord = Pair.Value.AppliedCenter;
+			break;
+		}
+	}
+	constexpr int32 NumRuns = 4;
+
+	for (int32 Iterations : IterationCounts)
+	{
+		FTerrainErosionSettings Settings = Erosion;
+		Settings.Iterations = FMath::Max(0, Iterations);
+
+		TArray<float> Heights;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Run = 0; Run < NumRuns; Run++)
+		{
+			FTerrainErosion::BuildTile(
+				ChunkCoord,
+				ChunkSize,
+				Settings,
+				[this](float X, float Y) { return SampleNoise(X, Y); },
+				Heights
+			);
+		}
+		const double MsPerTile = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumRuns;
+
+		const int32 TileSize = ChunkSize + 1 + 2 * Settings.GetHaloSize();
+		UE_LOG(LogTerrainChunk, Display, TEXT("Erosion : ChunkSize %d, %d itérations, tuile %dx%d -> %.2f ms/tuile"),
+			ChunkSize, Settings.Iterations, TileSize, TileSize, MsPerTile);
+	}
+}
+
+bool ATerrainChunkManager::GetPrimarySourceWindow(FIntPoint& OutCenter, int32& OutRadius) const
+{
+	// Source de plus forte priorité, la plus ancienne en cas d'égalité
+	const FStreamingSourceState* Primary = nullptr;
+	int32 PrimaryHandle = MAX_int32;
+	for (const auto& Pair : StreamingSources)
+	{
+		const FStreamingSourceState& State = Pair.Value;
+		if (State.AppliedRadius < 0)
+		{
+			continue;
+		}
+
+		if (!Primary || State.Source.Priority > Primary->Source.Priority
+			|| (State.Source.Priority == Primary->Source.Priority && Pair.Key < PrimaryHandle))
+		{
+			Primary = &State;
+			PrimaryHandle = Pair.Key;
+		}
+	}
+
+	if (!Primary)
+	{
+		return false;
+	}
+
+	OutCenter = Primary->AppliedCenter;
+	OutRadius = Primary->AppliedRadius;
+	return true;
+}
+
+void ATerrainChunkManager::UpdateFarField()
+{
+	FIntPoint Center;
+	int32 WindowRadius;
+	if (!bFarField || !GetPrimarySourceWindow(Center, WindowRadius) || FarFieldDistance <= WindowRadius)
+	{
+		if (FarFieldMesh && FarFieldMesh->GetNumSections() > 0)
+		{
+			ClearFarField();
+		}
+		return;
+	}
+
+	// Rien à faire tant que la source principale reste dans le même chunk et qu'aucun chunk n'apparaît ou ne disparaît
+	if (!bFarFieldDirty && Center == FarFieldCenter)
+	{
+		return;
+	}
+
+	FTerrainFarField::FSettings Settings;
+	Settings.ChunkSize = ChunkSize;
+	Settings.Radius = FarFieldDistance;
+	Settings.CellsPerChunk = FarFieldCellsPerChunk;
+	Settings.Scale = fScale;
+	Settings.UVScale = fUVScale;
+	Settings.ZMultiplier = ZMultiplier;
+
+	// Là où l'anneau recouvre les chunks proches, il doit passer sous les détails que ses cellules ne suivent pas
+	// Le type Perlin n'a qu'une octave, et SampleNoise multiplie déjà les coordonnées par la fréquence
+	// que GetNoise2D applique une seconde fois : la fréquence par échantillon est son carré
+	const float Step = static_cast<float>(ChunkSize) / FMath::Max(FarFieldCellsPerChunk, 1);
+	const float SampleFrequency = FMath::Square(NoiseGenerator->GetFrequency());
+	const float InterpolationError = FTerrainFarField::EstimateInterpolationError(Step, SampleFrequency);
+	Settings.Sink = FarFieldSink + InterpolationError * FMath::Abs(ZMultiplier);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 NumSamples = FarField.Update(
+		Center,
+		Settings,
+		[this](float X, float Y) { return SampleNoise(X, Y); },
+		[this](const FIntPoint& ChunkCoord) { return ActiveChunks.Contains(ChunkCoord); }
+	);
+
+	if (!FarFieldMesh)
+	{
+		FarFieldMesh = NewObject<UProceduralMeshComponent>(this, NAME_None, RF_Transient | RF_DuplicateTransient);
+		FarFieldMesh->RegisterComponent();
+	}
+
+	// Les triangles ne changent qu'avec les réglages ou les chunks affichés ; sinon seuls les vertices bougent
+	if (FarField.HasTopologyChanged() || FarFieldMesh->GetNumSections() == 0)
+	{
+		FarFieldMesh->CreateMeshSection(
+			0,
+			FarField.Vertices,
+			FarField.Triangles,
+			FarField.Normals,
+			FarField.UVs,
+			TArray<FColor>(),
+			FarField.Tangents,
+			false
+		);
+		FarFieldMesh->SetMaterial(0, Material);
+	}
+	else
+	{
+		FarFieldMesh->UpdateMeshSection(0, FarField.Vertices, FarField.Normals, FarField.UVs, TArray<FColor>(), FarField.Tangents);
+	}
+	FarFieldMesh->SetRelativeLocation(FarField.GetOrigin());
+
+	FarFieldCenter = Center;
+	bFarFieldDirty = false;
+
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	UE_LOG(LogTerrainChunk, Verbose, TEXT("Far field : %d échantillons, %d vertices, %d triangles, %.2f ms"),
+		NumSamples, FarField.GetNumVertices(), FarField.Triangles.Num() / 3, ElapsedMs);
+}
+
+void ATerrainChunkManager::ClearFarField()
+{
+	FarField.Reset();
+	if (FarFieldMesh)
+	{
+		FarFieldMesh->ClearAllMeshSections();
+	}
+	bFarFieldDirty = true;
+}
+
+void ATerrainChunkManager::StartRecording(const FString& Name)
+{
+	RecordingTrace.Samples.Reset();
+	RecordingName = Name;
+	RecordingStartTime = GetWorld()->GetTimeSeconds();
+	bRecording = true;
+
+	UE_LOG(LogTerrainChunk, Display, TEXT("Enregistrement du trajet %s"), *Name);
+}
+
+void ATerrainChunkManager::StopRecording()
+{
+	if (!bRecording)
+	{
+		return;
+	}
+	bRecording = false;
+
+	const FString Path = FTerrainTraversalTrace::GetTracePath(RecordingName);
+	if (RecordingTrace.SaveToFile(Path))
+	{
+		UE_LOG(LogTerrainChunk, Display, TEXT("Trajet %s : %d positions, %.1f s -> %s"),
+			*RecordingName, RecordingTrace.Samples.Num(), RecordingTrace.GetDuration(), *Path);
+	}
+	else
+	{
+		UE_LOG(LogTerrainChunk, Error, TEXT("Impossible d'écrire le trajet %s"), *Path);
+	}
+}
+
+void ATerrainChunkManager::RecordFrame()
+{
+	APawn* Pawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!Pawn)
+	{
+		return;
+	}
+
+	const double Time = GetWorld()->GetTimeSeconds() - RecordingStartTime;
+	if (RecordingTrace.Samples.Num() > 0 && Time - RecordingTrace.Samples.Last().Time < RecordInterval)
+	{
+		return;
+	}
+
+	RecordingTrace.Samples.Add(FTerrainTraversalSample{ Time, Pawn->GetActorLocation() });
+}
+
+bool ATerrainChunkManager::StartReplay(const FString& TraceName, float Speed, const FString& Label, bool bQuitWhenDone)
+{
+	if (bReplaying)
+	{
+		UE_LOG(LogTerrainChunk, Warning, TEXT("Un rejeu est déjà en cours"));
+		return false;
+	}
+
+	const FString TracePath = FTerrainTraversalTrace::GetTracePath(TraceName);
+	if (!ReplayTrace.LoadFromFile(TracePath))
+	{
+		UE_LOG(LogTerrainChunk, Error, TEXT("Trajet introuvable ou vide : %s"), *TracePath);
+		if (bQuitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+		return false;
+	}
+
+	// Seules les positions enregistrées pilotent le streaming pendant le rejeu
+	bReplaySavedAutoRegister = bAutoRegisterPlayerControllers;
+	bAutoRegisterPlayerControllers = false;
+	for (const auto& Pair : PlayerSourceHandles)
+	{
+		UnregisterStreamingSource(Pair.Value);
+	}
+	PlayerSourceHandles.Empty();
+
+	// Partir d'un terrain vide pour que chaque rejeu mesure la même chose
+	ClearChunks();
+
+	FTerrainStreamingSource Source;
+	Source.Location = ReplayTrace.Samples[0].Location;
+	ReplaySourceHandle = RegisterStreamingSource(Source);
+
+	ReplaySpeed = FMath::Max(Speed, 0.01f);
+	ReplayTime = 0.0;
+	bReplayQuitWhenDone = bQuitWhenDone;
+	ReplayStats.Reset(ReplayHitchThresholdsMs);
+
+	// Le moteur avance du même pas que le trajet : DeltaTime, timers, physique et GC voient la même
+	// suite de frames à chaque rejeu, quelle que soit la durée réelle d'une frame
+	bReplaySavedFixedTimeStep = FApp::UseFixedTimeStep();
+	ReplaySavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(ReplayFixedStep * ReplaySpeed);
+
+	int32 BenchmarkFps = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("fps="), BenchmarkFps);
+
+	ReplayConfig.Reset();
+	ReplayConfig.Emplace(TEXT("Trace"), TraceName);
+	ReplayConfig.Emplace(TEXT("Label"), Label);
+	ReplayConfig.Emplace(TEXT("Speed"), FString::Printf(TEXT("%.2f"), ReplaySpeed));
+	ReplayConfig.Emplace(TEXT("FixedStep"), FString::Printf(TEXT("%.6f"), ReplayFixedStep));
+	ReplayConfig.Emplace(TEXT("EngineFixedDeltaTime"), FString::Printf(TEXT("%.6f"), FApp::GetFixedDeltaTime()));
+	ReplayConfig.Emplace(TEXT("Benchmark"), FApp::IsBenchmarking() ? TEXT("1") : TEXT("0"));
+	ReplayConfig.Emplace(TEXT("BenchmarkFps"), FString::FromInt(BenchmarkFps));
+	ReplayConfig.Emplace(TEXT("ChunkSize"), FString::FromInt(ChunkSize));
+	ReplayConfig.Emplace(TEXT("RenderDistance"), FString::FromInt(RenderDistance));
+	ReplayConfig.Emplace(TEXT("MaxChunkBuildsPerTick"), FString::FromInt(MaxChunkBuildsPerTick));
+	ReplayConfig.Emplace(TEXT("Erosion"), Erosion.bEnabled ? TEXT("1") : TEXT("0"));
+	ReplayConfig.Emplace(TEXT("ErosionIterations"), FString::FromInt(Erosion.Iterations));
+	ReplayConfig.Emplace(TEXT("FarField"), bFarField ? TEXT("1") : TEXT("0"));
+	ReplayConfig.Emplace(TEXT("FarFieldDistance"), FString::FromInt(FarFieldDistance));
+	ReplayConfig.Emplace(TEXT("FarFieldCellsPerChunk"), FString::FromInt(FarFieldCellsPerChunk));
+	ReplayConfig.Emplace(TEXT("WorkerThreads"), FString::FromInt(FTaskGraphInterface::Get().GetNumWorkerThreads()));
+	ReplayConfig.Emplace(TEXT("LogicalCores"), FString::FromInt(FPlatformMisc::NumberOfCoresIncludingHyperthreads()));
+
+	// Pas d'horodatage dans le nom : le même trajet et le même label écrasent le rapport précédent
+	const FString ReportName = Label.IsEmpty() ? TraceName : TraceName + TEXT("_") + Label;
+	ReplayReportPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TerrainReplays"), ReportName + TEXT(".txt"));
+
+	ReplayGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddLambda([this]()
+	{
+		ReplayStats.AddGarbageCollection();
+	});
+
+	ReplayLastFrameTime = FPlatformTime::Seconds();
+	bReplaying = true;
+
+	UE_LOG(LogTerrainChunk, Display, TEXT("Rejeu de %s : %d positions, %.1f s à x%.2f"),
+		*TraceName, ReplayTrace.Samples.Num(), ReplayTrace.GetDuration(), ReplaySpeed);
+	return true;
+}
+
+void ATerrainChunkManager::FinishReplay()
+{
+	bReplaying = false;
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(ReplayGarbageCollectHandle);
+	RestoreEngineTimeStep();
+
+	UnregisterStreamingSource(ReplaySourceHandle);
+	ReplaySourceHandle = INDEX_NONE;
+	bAutoRegisterPlayerControllers = bReplaySavedAutoRegister;
+
+	const FString Report = ReplayStats.BuildReport(ReplayConfig);
+	if (FFileHelper::SaveStringToFile(Report, *ReplayReportPath))
+	{
+		UE_LOG(LogTerrainChunk, Display, TEXT("Rejeu terminé : %d frames -> %s"), ReplayStats.GetNumFrames(), *ReplayReportPath);
+	}
+	else
+	{
+		UE_LOG(LogTerrainChunk, Error, TEXT("Impossible d'écrire le rapport %s"), *ReplayReportPath);
+	}
+
+	if (bReplayQuitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void ATerrainChunkManager::RestoreEngineTimeStep()
+{
+	FApp::SetUseFixedTimeStep(bReplaySavedFixedTimeStep);
+	FApp::SetFixedDeltaTime(ReplaySavedFixedDeltaTime);
 }
\ No newline at end of file
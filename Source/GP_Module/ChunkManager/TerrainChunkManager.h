@@ -7,8 +7,17 @@
 #include "ProceduralMeshComponent.h"
 #include "FastNoiseWrapper.h"
 #include "KismetProceduralMeshLibrary.h"
+#include "TerrainErosion.h"
+#include "TerrainStreamingSource.h"
+#include "TerrainFarField.h"
+#include "TerrainTraversalReplay.h"
+#include "TerrainAsyncJob.h"
 #include "TerrainChunkManager.generated.h"
 
+class APlayerController;
+struct FTerrainChunkPreviewJob;
+struct FTerrainErosionJob;
+
 UCLASS()
 class GP_MODULE_API ATerrainChunkManager : public AActor
 {
@@ -45,23 +54,158 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Terrain Generation")
 	UMaterialInterface* Material;
 
+	UPROPERTY(EditAnywhere, Category = "Terrain Generation|Erosion")
+	FTerrainErosionSettings Erosion;
+
+	// Nombre de tuiles érodées gardées en mémoire pour les chunks qui reviennent dans le champ
+	UPROPERTY(EditAnywhere, Category = "Terrain Generation|Erosion", Meta = (ClampMin = 0))
+	int32 MaxCachedErodedTiles = 256;
+
+	// Anneau basse résolution au-delà de RenderDistance, autour de la source principale
+	UPROPERTY(EditAnywhere, Category = "Terrain Generation|Far Field")
+	bool bFarField = true;
+
+	// Rayon de l'anneau, en chunks
+	UPROPERTY(EditAnywhere, Category = "Terrain Generation|Far Field", Meta = (ClampMin = 1))
+	int32 FarFieldDistance = 16;
+
+	// Cellules par côté de chunk ; ChunkSize / FarFieldCellsPerChunk échantillons d'écart
+	UPROPERTY(EditAnywhere, Category = "Terrain Generation|Far Field", Meta = (ClampMin = 1))
+	int32 FarFieldCellsPerChunk = 4;
+
+	// Marge d'abaissement de l'anneau sous les chunks proches, ajoutée à l'erreur d'interpolation estimée
+	UPROPERTY(EditAnywhere, Category = "Terrain Generation|Far Field", Meta = (ClampMin = 0.0))
+	float FarFieldSink = 50.0f;
+
+	// Crée une source de streaming pour chaque PlayerController (écran partagé, serveur d'écoute, spectateurs)
+	UPROPERTY(EditAnywhere, Category = "Terrain Streaming")
+	bool bAutoRegisterPlayerControllers = true;
+
+	// Nombre maximal de chunks construits par frame ; 0 pour tout construire immédiatement.
+	// Dans la preview de l'éditeur : nombre maximal de jobs de construction en cours.
+	UPROPERTY(EditAnywhere, Category = "Terrain Streaming", Meta = (ClampMin = 0))
+	int32 MaxChunkBuildsPerTick = 8;
+
+	UFUNCTION(BlueprintCallable, Category = "Terrain Streaming")
+	int32 RegisterStreamingSource(const FTerrainStreamingSource& Source);
+
+	UFUNCTION(BlueprintCallable, Category = "Terrain Streaming")
+	void UpdateStreamingSource(int32 Handle, const FTerrainStreamingSource& Source);
+
+	UFUNCTION(BlueprintCallable, Category = "Terrain Streaming")
+	void UnregisterStreamingSource(int32 Handle);
+
+#if WITH_EDITORONLY_DATA
+	// Génère les chunks autour de l'acteur dans l'éditeur quand une propriété change
+	UPROPERTY(EditAnywhere, Category = "Preview")
+	bool bEditorPreview = true;
+
+	// Délai sans modification avant de relancer la génération
+	UPROPERTY(EditAnywhere, Category = "Preview", Meta = (ClampMin = 0.0))
+	float PreviewDebounceSeconds = 0.2f;
+
+	// Pas de la passe grossière qui couvre d'abord toute la fenêtre ; 1 pour construire directement à pleine résolution
+	UPROPERTY(EditAnywhere, Category = "Preview", Meta = (ClampMin = 1))
+	int32 PreviewCoarseStep = 8;
+
+	// Temps (ms) consacré par frame à envoyer les résultats des jobs aux meshes
+	UPROPERTY(EditAnywhere, Category = "Preview", Meta = (ClampMin = 0.1))
+	float PreviewApplyBudgetMs = 4.0f;
+#endif
+
+	// Intervalle entre deux positions enregistrées par Terrain.Record
+	UPROPERTY(EditAnywhere, Category = "Terrain Benchmark", Meta = (ClampMin = 0.0))
+	float RecordInterval = 0.1f;
+
+	// Pas de temps fixe du rejeu, indépendant de la durée réelle des frames
+	UPROPERTY(EditAnywhere, Category = "Terrain Benchmark", Meta = (ClampMin = 0.001))
+	float ReplayFixedStep = 1.0f / 60.0f;
+
+	// Seuils (ms) au-delà desquels une frame compte comme un à-coup
+	UPROPERTY(EditAnywhere, Category = "Terrain Benchmark")
+	TArray<float> ReplayHitchThresholdsMs = { 8.0f, 16.0f, 33.0f };
+
+	// Mesure le coût d'une tuile érodée pour plusieurs nombres d'itérations
+	void ReportErosionCost(const TArray<int32>& IterationCounts);
+
+	// Enregistre le trajet du pawn du premier joueur dans Saved/TerrainTraces/<Name>.csv
+	void StartRecording(const FString& Name);
+	void StopRecording();
+
+	// Rejoue un trajet à vitesse Speed et écrit le rapport dans Saved/TerrainReplays
+	bool StartReplay(const FString& TraceName, float Speed, const FString& Label, bool bQuitWhenDone);
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
+	virtual bool ShouldTickIfViewportsOnly() const override;
+
+#if WITH_EDITOR
+	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	virtual void BeginDestroy() override;
+	virtual bool IsReadyForFinishDestroy() override;
 
 private:
 	UPROPERTY()
 	UFastNoiseWrapper* NoiseGenerator;
 
 	TMap<FIntPoint, UProceduralMeshComponent*> ActiveChunks;
-	FIntPoint CurrentPlayerChunk;
 
-	void UpdateChunks();
 	void CreateChunk(const FIntPoint& ChunkCoord);
+	UProceduralMeshComponent* AddChunkComponent(const FIntPoint& ChunkCoord);
 	void RemoveChunk(const FIntPoint& ChunkCoord);
-	bool IsChunkInRange(const FIntPoint& ChunkCoord);
+	void ClearChunks();
 	FIntPoint WorldToChunkCoord(const FVector& WorldLocation);
 
+	// État d'une source : la fenêtre déjà appliquée sert à calculer les différences
+	struct FStreamingSourceState
+	{
+		FTerrainStreamingSource Source;
+		FIntPoint AppliedCenter = FIntPoint::ZeroValue;
+		int32 AppliedRadius = -1;
+		bool bTracksActor = false;
+	};
+
+	TMap<int32, FStreamingSourceState> StreamingSources;
+	TMap<TWeakObjectPtr<APlayerController>, int32> PlayerSourceHandles;
+	int32 NextStreamingSourceHandle = 0;
+
+	// Union des fenêtres : nombre de sources qui couvrent chaque chunk
+	TMap<FIntPoint, int32> ChunkReferences;
+
+	void UpdateStreamingSources();
+	void RegisterPlayerControllers();
+	bool ResolveSourceLocation(const FTerrainStreamingSource& Source, FVector& OutLocation) const;
+	void ApplySourceWindow(FStreamingSourceState& State, const FIntPoint& NewCenter, int32 NewRadius);
+	void AddChunkReference(const FIntPoint& ChunkCoord, float BuildPriority);
+	void ReleaseChunkReference(const FIntPoint& ChunkCoord);
+	int32 GetDistanceToNearestSource(const FIntPoint& ChunkCoord) const;
+
+	// File de construction partagée par toutes les sources (tas binaire, plus petite priorité en tête)
+	struct FChunkBuildRequest
+	{
+		FIntPoint ChunkCoord;
+		float Priority;
+
+		bool operator<(const FChunkBuildRequest& Other) const { return Priority < Other.Priority; }
+	};
+
+	TArray<FChunkBuildRequest> BuildQueue;
+	TMap<FIntPoint, float> PendingBuilds;
+	int32 ProcessBuildQueue(int32 MaxBuilds);
+	float GetBuildPriority(const FIntPoint& ChunkCoord) const;
+	void RefreshBuildPriorities();
+
+	// Chunks retirés dont la destruction est encore différée par RemoveChunk ; EndPlay détruit ceux qui restent
+	UPROPERTY(Transient, DuplicateTransient)
+	TArray<UProceduralMeshComponent*> ChunksPendingDestroy;
+
+	void DestroyPendingChunks();
+
 	UPROPERTY()
 	int32 MaxVerticesPerChunk;
 	
@@ -72,11 +216,91 @@ private:
     
 	// Méthodes d'optimisation
 	void InitializeBuffers();
+	void ConfigureNoise();
 	void GenerateOptimizedVertices(const FIntPoint& ChunkCoord, TArray<FVector>& OutVertices, TArray<FVector2D>& OutUVs);
 	void GenerateOptimizedIndices(TArray<int32>& OutIndices);
 	float GetCachedNoise(float X, float Y);
+	float SampleNoise(float X, float Y) const;
     
 	// Cache pour le bruit
 	TMap<FVector2D, float> NoiseCache;
 	void ClearNoiseCache();
+
+	// Hauteurs érodées (unités du bruit) par chunk, construites en parallèle
+	TMap<FIntPoint, TArray<float>> ErodedTileCache;
+	void BuildErodedTiles(const TArray<FIntPoint>& ChunkCoords);
+	void TrimErodedTileCache();
+
+	// Tuiles érodées en arrière-plan pendant le streaming ; une tuile terminée remet son chunk dans la file
+	TMap<FIntPoint, TSharedPtr<FTerrainErosionJob>> ErosionJobs;
+	void LaunchErosionJob(const FIntPoint& ChunkCoord);
+	void CollectErosionJobs();
+
+	// Jobs de preview et d'érosion, suivis jusqu'à ce qu'ils ne lisent plus NoiseGenerator
+	FTerrainJobTracker NoiseJobs;
+
+	UPROPERTY(Transient, DuplicateTransient)
+	UProceduralMeshComponent* FarFieldMesh = nullptr;
+
+	FTerrainFarField FarField;
+	FIntPoint FarFieldCenter = FIntPoint::ZeroValue;
+	bool bFarFieldDirty = true;  // Réglages, ZMultiplier ou chunks affichés modifiés
+	void UpdateFarField();
+	void ClearFarField();
+	bool GetPrimarySourceWindow(FIntPoint& OutCenter, int32& OutRadius) const;
+
+	// Enregistrement et rejeu de trajets pour le benchmark de streaming
+	FTerrainTraversalTrace RecordingTrace;
+	FString RecordingName;
+	double RecordingStartTime = 0.0;
+	bool bRecording = false;
+
+	FTerrainTraversalTrace ReplayTrace;
+	FTerrainReplayStats ReplayStats;
+	TArray<TPair<FString, FString>> ReplayConfig;
+	FString ReplayReportPath;
+	FDelegateHandle ReplayGarbageCollectHandle;
+	int32 ReplaySourceHandle = INDEX_NONE;
+	double ReplayTime = 0.0;
+	double ReplayLastFrameTime = 0.0;
+	float ReplaySpeed = 1.0f;
+	bool bReplaying = false;
+	bool bReplayQuitWhenDone = false;
+	bool bReplaySavedAutoRegister = true;
+	bool bReplaySavedFixedTimeStep = false;
+	double ReplaySavedFixedDeltaTime = 0.0;
+
+	void RecordFrame();
+	void FinishReplay();
+	void RestoreEngineTimeStep();
+
+#if WITH_EDITORONLY_DATA
+	int32 PreviewSourceHandle = INDEX_NONE;
+	float PreviewDebounceRemaining = 0.0f;
+	float PreviewAppliedZMultiplier = 0.0f;
+	bool bPreviewPending = false;
+	bool bPreviewNeedsRebuild = false;
+
+	// Résolution et ZMultiplier du mesh affiché par chaque chunk de la preview
+	struct FPreviewChunkState
+	{
+		int32 Step = 0;
+		float ZMultiplier = 0.0f;
+	};
+
+	TMap<FIntPoint, FPreviewChunkState> PreviewChunkStates;
+
+	// Un job au plus par chunk ; NoiseJobs suit aussi ceux qui ont été annulés
+	TMap<FIntPoint, TSharedPtr<FTerrainChunkPreviewJob>> PreviewJobs;
+#endif
+
+#if WITH_EDITOR
+	void RequestPreview(bool bRebuild);
+	void UpdatePreview(float DeltaTime);
+	void StopPreview();
+	void SchedulePreviewJobs();
+	void LaunchPreviewJob(const FIntPoint& ChunkCoord, int32 Step);
+	void ApplyPreviewResults();
+	void CancelPreviewJobs();
+#endif
 };
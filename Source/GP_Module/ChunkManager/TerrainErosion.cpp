@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TerrainErosion.h"
+
+namespace TerrainErosion
+{
+	// Voisins dans un ordre fixe pour que les sommes flottantes soient identiques d'une tuile à l'autre
+	static const int32 OffsetX[4] = { 1, -1, 0, 0 };
+	static const int32 OffsetY[4] = { 0, 0, 1, -1 };
+	static const int32 Opposite[4] = { 1, 0, 3, 2 };
+}
+
+int32 FTerrainErosionSettings::GetHaloSize() const
+{
+	return Iterations * FTerrainErosion::PassesPerIteration;
+}
+
+void FTerrainErosion::BuildTile(
+	const FIntPoint& ChunkCoord,
+	int32 ChunkSize,
+	const FTerrainErosionSettings& Settings,
+	TFunctionRef<float(float, float)> SampleHeight,
+	TArray<float>& OutHeights)
+{
+	const int32 Halo = Settings.GetHaloSize();
+	const int32 ChunkVerts = ChunkSize + 1;
+	const int32 TileSize = ChunkVerts + 2 * Halo;
+
+	// Échantillonner le bruit sur le chunk et son halo
+	TArray<float> Tile;
+	Tile.SetNumUninitialized(TileSize * TileSize);
+
+	const float OriginX = ChunkCoord.X * ChunkSize - Halo;
+	const float OriginY = ChunkCoord.Y * ChunkSize - Halo;
+
+	for (int32 Y = 0; Y < TileSize; Y++)
+	{
+		for (int32 X = 0; X < TileSize; X++)
+		{
+			Tile[X + Y * TileSize] = SampleHeight(OriginX + X, OriginY + Y);
+		}
+	}
+
+	Erode(Tile, TileSize, Settings);
+
+	// Ne garder que le centre, exact grâce au halo
+	OutHeights.SetNumUninitialized(ChunkVerts * ChunkVerts);
+	for (int32 Y = 0; Y < ChunkVerts; Y++)
+	{
+		FMemory::Memcpy(
+			&OutHeights[Y * ChunkVerts],
+			&Tile[Halo + (Y + Halo) * TileSize],
+			ChunkVerts * sizeof(float)
+		);
+	}
+}
+
+void FTerrainErosion::Erode(TArray<float>& Heights, int32 Size, const FTerrainErosionSettings& Settings)
+{
+	using namespace TerrainErosion;
+
+	const int32 NumCells = Size * Size;
+	check(Heights.Num() == NumCells);
+
+	TArray<float> Water;
+	TArray<float> Sediment;
+	TArray<float> Flux;
+	TArray<float> NextHeights;
+	TArray<float> NextWater;
+	TArray<float> NextSediment;
+
+	Water.Init(Settings.RainAmount, NumCells);
+	Sediment.Init(0.0f, NumCells);
+	Flux.SetNumZeroed(NumCells * 4);
+	NextHeights.SetNumUninitialized(NumCells);
+	NextWater.SetNumUninitialized(NumCells);
+	NextSediment.SetNumUninitialized(NumCells);
+
+	auto IsInside = [Size](int32 X, int32 Y)
+	{
+		return X >= 0 && Y >= 0 && X < Size && Y < Size;
+	};
+
+	for (int32 Iteration = 0; Iteration < Settings.Iterations; Iteration++)
+	{
+		// Passe 1 : débit d'eau sortant vers les voisins plus bas
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const int32 Index = X + Y * Size;
+				const float Level = Heights[Index] + Water[Index];
+
+				float Drops[4];
+				float TotalDrop = 0.0f;
+				for (int32 K = 0; K < 4; K++)
+				{
+					const int32 NX = X + OffsetX[K];
+					const int32 NY = Y + OffsetY[K];
+					Drops[K] = 0.0f;
+					if (IsInside(NX, NY))
+					{
+						const int32 Neighbor = NX + NY * Size;
+						Drops[K] = FMath::Max(0.0f, Level - (Heights[Neighbor] + Water[Neighbor]));
+					}
+					TotalDrop += Drops[K];
+				}
+
+				const float Outflow = FMath::Min(Water[Index], TotalDrop * 0.5f);
+				for (int32 K = 0; K < 4; K++)
+				{
+					Flux[Index * 4 + K] = TotalDrop > 0.0f ? Outflow * Drops[K] / TotalDrop : 0.0f;
+				}
+			}
+		}
+
+		// Passe 2 : transport de l'eau et des sédiments, érosion/dépôt, évaporation
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const int32 Index = X + Y * Size;
+
+				float OutWater = 0.0f;
+				float InWater = 0.0f;
+				float InSediment = 0.0f;
+				for (int32 K = 0; K < 4; K++)
+				{
+					OutWater += Flux[Index * 4 + K];
+
+					const int32 NX = X + OffsetX[K];
+					const int32 NY = Y + OffsetY[K];
+					if (IsInside(NX, NY))
+					{
+						const int32 Neighbor = NX + NY * Size;
+						const float Incoming = Flux[Neighbor * 4 + Opposite[K]];
+						InWater += Incoming;
+						if (Water[Neighbor] > 0.0f)
+						{
+							InSediment += Sediment[Neighbor] * Incoming / Water[Neighbor];
+						}
+					}
+				}
+
+				const float OutSediment = Water[Index] > 0.0f ? Sediment[Index] * OutWater / Water[Index] : 0.0f;
+				float NewSediment = Sediment[Index] - OutSediment + InSediment;
+				float NewHeight = Heights[Index];
+
+				// Le débit sortant sert d'approximation de la vitesse de l'eau
+				const float Capacity = Settings.SedimentCapacity * OutWater;
+				if (NewSediment > Capacity)
+				{
+					const float Deposited = Settings.DepositionRate * (NewSediment - Capacity);
+					NewHeight += Deposited;
+					NewSediment -= Deposited;
+				}
+				else
+				{
+					const float Eroded = Settings.ErosionRate * (Capacity - NewSediment);
+					NewHeight -= Eroded;
+					NewSediment += Eroded;
+				}
+
+				NextHeights[Index] = NewHeight;
+				NextSediment[Index] = NewSediment;
+				NextWater[Index] = (Water[Index] - OutWater + InWater) * (1.0f - Settings.EvaporationRate) + Settings.RainAmount;
+			}
+		}
+
+		Swap(Heights, NextHeights);
+		Swap(Water, NextWater);
+		Swap(Sediment, NextSediment);
+
+		// Passe 3 : matière qui s'éboule au-delà de l'angle de talus
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const int32 Index = X + Y * Size;
+
+				float Excess[4];
+				float TotalExcess = 0.0f;
+				float MaxExcess = 0.0f;
+				for (int32 K = 0; K < 4; K++)
+				{
+					const int32 NX = X + OffsetX[K];
+					const int32 NY = Y + OffsetY[K];
+					Excess[K] = 0.0f;
+					if (IsInside(NX, NY))
+					{
+						const int32 Neighbor = NX + NY * Size;
+						Excess[K] = FMath::Max(0.0f, Heights[Index] - Heights[Neighbor] - Settings.TalusThreshold);
+					}
+					TotalExcess += Excess[K];
+					MaxExcess = FMath::Max(MaxExcess, Excess[K]);
+				}
+
+				const float Moved = Settings.ThermalRate * MaxExcess * 0.5f;
+				for (int32 K = 0; K < 4; K++)
+				{
+					Flux[Index * 4 + K] = TotalExcess > 0.0f ? Moved * Excess[K] / TotalExcess : 0.0f;
+				}
+			}
+		}
+
+		// Passe 4 : redistribution de la matière éboulée
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const int32 Index = X + Y * Size;
+
+				float NewHeight = Heights[Index];
+				for (int32 K = 0; K < 4; K++)
+				{
+					NewHeight -= Flux[Index * 4 + K];
+
+					const int32 NX = X + OffsetX[K];
+					const int32 NY = Y + OffsetY[K];
+					if (IsInside(NX, NY))
+					{
+						NewHeight += Flux[(NX + NY * Size) * 4 + Opposite[K]];
+					}
+				}
+				NextHeights[Index] = NewHeight;
+			}
+		}
+
+		Swap(Heights, NextHeights);
+	}
+}
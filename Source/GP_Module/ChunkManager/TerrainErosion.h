@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainErosion.generated.h"
+
+// Paramètres de l'érosion, exprimés dans les unités du bruit (avant ZMultiplier)
+USTRUCT(BlueprintType)
+struct GP_MODULE_API FTerrainErosionSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Erosion")
+	bool bEnabled = false;
+
+	// Chaque itération lit 4 cellules de voisinage : le halo vaut Iterations * 4
+	UPROPERTY(EditAnywhere, Category = "Erosion", Meta = (ClampMin = 0, ClampMax = 64))
+	int32 Iterations = 8;
+
+	UPROPERTY(EditAnywhere, Category = "Erosion|Hydraulic", Meta = (ClampMin = 0.0))
+	float RainAmount = 0.01f;
+
+	UPROPERTY(EditAnywhere, Category = "Erosion|Hydraulic", Meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float EvaporationRate = 0.05f;
+
+	UPROPERTY(EditAnywhere, Category = "Erosion|Hydraulic", Meta = (ClampMin = 0.0))
+	float SedimentCapacity = 4.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Erosion|Hydraulic", Meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float ErosionRate = 0.3f;
+
+	UPROPERTY(EditAnywhere, Category = "Erosion|Hydraulic", Meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float DepositionRate = 0.3f;
+
+	// Différence de hauteur maximale entre deux cellules voisines avant éboulement
+	UPROPERTY(EditAnywhere, Category = "Erosion|Thermal", Meta = (ClampMin = 0.0))
+	float TalusThreshold = 0.02f;
+
+	UPROPERTY(EditAnywhere, Category = "Erosion|Thermal", Meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float ThermalRate = 0.25f;
+
+	int32 GetHaloSize() const;
+};
+
+/**
+ * Érosion hydraulique + thermique sur une tuile de chunk entourée d'un halo.
+ *
+ * Chaque passe ne lit que les 4 voisins directs de l'état précédent (schéma de Jacobi),
+ * donc l'erreur introduite par le bord de la tuile avance d'une cellule par passe.
+ * Avec un halo d'au moins Iterations * PassesPerIteration cellules, le centre de la tuile
+ * est identique à une érosion sur un terrain infini : pas de couture entre chunks et
+ * résultat indépendant de l'ordre de traitement ou du nombre de threads.
+ */
+class GP_MODULE_API FTerrainErosion
+{
+public:
+	static constexpr int32 PassesPerIteration = 4;
+
+	// SampleHeight doit être thread-safe : les tuiles sont construites en parallèle
+	static void BuildTile(
+		const FIntPoint& ChunkCoord,
+		int32 ChunkSize,
+		const FTerrainErosionSettings& Settings,
+		TFunctionRef<float(float, float)> SampleHeight,
+		TArray<float>& OutHeights
+	);
+
+	// Érode une grille carrée Size x Size sur place
+	static void Erode(TArray<float>& Heights, int32 Size, const FTerrainErosionSettings& Settings);
+};
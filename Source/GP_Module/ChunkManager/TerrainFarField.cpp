@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TerrainFarField.h"
+
+int32 FTerrainFarField::Update(
+	const FIntPoint& CenterChunk,
+	const FSettings& Settings,
+	TFunctionRef<float(float, float)> SampleHeight,
+	TFunctionRef<bool(const FIntPoint&)> IsChunkCovered
+)
+{
+	const int32 CellsPerChunk = FMath::Max(Settings.CellsPerChunk, 1);
+	const int32 NumCells = (2 * Settings.Radius + 1) * CellsPerChunk;
+	const int32 NewNumPoints = NumCells + 1;
+	const float Step = static_cast<float>(Settings.ChunkSize) / CellsPerChunk;
+
+	// Un changement de grille invalide le tampon ; un changement de couverture ne touche que les indices
+	const bool bLayoutChanged = NewNumPoints != NumPoints
+		|| Settings.ChunkSize != AppliedSettings.ChunkSize
+		|| CellsPerChunk != AppliedSettings.CellsPerChunk;
+
+	if (bLayoutChanged)
+	{
+		NumPoints = NewNumPoints;
+		Heights.SetNumUninitialized(NumPoints * NumPoints);
+		bHasSamples = false;
+	}
+
+	AppliedSettings = Settings;
+	AppliedSettings.CellsPerChunk = CellsPerChunk;
+
+	// Chunks proches affichés, relevés chunk par chunk plutôt que cellule par cellule
+	const int32 NumChunks = 2 * Settings.Radius + 1;
+	TBitArray<> NewCoverage(false, NumChunks * NumChunks);
+	for (int32 Y = 0; Y < NumChunks; Y++)
+	{
+		for (int32 X = 0; X < NumChunks; X++)
+		{
+			const FIntPoint ChunkCoord(CenterChunk.X - Settings.Radius + X, CenterChunk.Y - Settings.Radius + Y);
+			NewCoverage[X + Y * NumChunks] = IsChunkCovered(ChunkCoord);
+		}
+	}
+
+	bTopologyChanged = bLayoutChanged || NewCoverage != Coverage || Triangles.Num() == 0;
+	if (bTopologyChanged)
+	{
+		Coverage = MoveTemp(NewCoverage);
+		BuildTriangles();
+	}
+
+	// Indices globaux du premier point de la grille
+	const FIntPoint Origin(
+		(CenterChunk.X - Settings.Radius) * CellsPerChunk,
+		(CenterChunk.Y - Settings.Radius) * CellsPerChunk
+	);
+
+	// Seuls les points absents de l'ancienne fenêtre sont échantillonnés
+	int32 NumSamples = 0;
+	for (int32 Y = 0; Y < NumPoints; Y++)
+	{
+		const int32 GlobalY = Origin.Y + Y;
+		const bool bRowKnown = bHasSamples && GlobalY >= AppliedOrigin.Y && GlobalY < AppliedOrigin.Y + NumPoints;
+
+		for (int32 X = 0; X < NumPoints; X++)
+		{
+			const int32 GlobalX = Origin.X + X;
+			if (bRowKnown && GlobalX >= AppliedOrigin.X && GlobalX < AppliedOrigin.X + NumPoints)
+			{
+				continue;
+			}
+
+			Heights[Wrap(GlobalX) + Wrap(GlobalY) * NumPoints] = SampleHeight(GlobalX * Step, GlobalY * Step);
+			NumSamples++;
+		}
+	}
+
+	AppliedOrigin = Origin;
+	bHasSamples = true;
+
+	// Positions locales à GetOrigin(), normales par différences centrées
+	const int32 NumVertices = NumPoints * NumPoints;
+	Vertices.SetNumUninitialized(NumVertices);
+	Normals.SetNumUninitialized(NumVertices);
+	UVs.SetNumUninitialized(NumVertices);
+	Tangents.SetNumUninitialized(NumVertices);
+
+	const float Spacing = Step * Settings.Scale;
+	auto HeightAt = [this, &Origin](int32 X, int32 Y)
+	{
+		X = FMath::Clamp(X, 0, NumPoints - 1);
+		Y = FMath::Clamp(Y, 0, NumPoints - 1);
+		return Heights[Wrap(Origin.X + X) + Wrap(Origin.Y + Y) * NumPoints] * AppliedSettings.ZMultiplier;
+	};
+
+	for (int32 Y = 0; Y < NumPoints; Y++)
+	{
+		for (int32 X = 0; X < NumPoints; X++)
+		{
+			const int32 Index = X + Y * NumPoints;
+			const float SlopeX = (HeightAt(X + 1, Y) - HeightAt(X - 1, Y)) / (2.0f * Spacing);
+			const float SlopeY = (HeightAt(X, Y + 1) - HeightAt(X, Y - 1)) / (2.0f * Spacing);
+
+			Vertices[Index] = FVector(X * Spacing, Y * Spacing, HeightAt(X, Y) - Settings.Sink);
+			Normals[Index] = FVector(-SlopeX, -SlopeY, 1.0f).GetSafeNormal();
+			Tangents[Index] = FProcMeshTangent(FVector(1.0f, 0.0f, SlopeX).GetSafeNormal(), false);
+			UVs[Index] = FVector2D(X * Step * Settings.UVScale, Y * Step * Settings.UVScale);
+		}
+	}
+
+	return NumSamples;
+}
+
+void FTerrainFarField::Reset()
+{
+	bHasSamples = false;
+}
+
+float FTerrainFarField::EstimateInterpolationError(float Step, float SampleFrequency)
+{
+	// Borne d'une sinusoïde d'amplitude 1 (l'étendue du Perlin) échantillonnée tous les Step : 1 - cos(pi f h).
+	// Au-delà d'un échantillon par période, le bruit n'est plus suivi du tout.
+	const float CyclesPerStep = SampleFrequency * Step;
+	return CyclesPerStep < 1.0f ? 1.0f - FMath::Cos(PI * CyclesPerStep) : 2.0f;
+}
+
+FVector FTerrainFarField::GetOrigin() const
+{
+	const float Step = static_cast<float>(AppliedSettings.ChunkSize) / AppliedSettings.CellsPerChunk;
+	return FVector(AppliedOrigin.X * Step * AppliedSettings.Scale, AppliedOrigin.Y * Step * AppliedSettings.Scale, 0.0f);
+}
+
+void FTerrainFarField::BuildTriangles()
+{
+	const int32 CellsPerChunk = AppliedSettings.CellsPerChunk;
+	const int32 NumCells = NumPoints - 1;
+	const int32 NumChunks = NumCells / CellsPerChunk;
+
+	// Une cellule n'est retirée que si ses 8 voisines sont aussi sous des chunks affichés :
+	// il reste une cellule de recouvrement sous le bord des chunks proches pour éviter les fentes
+	auto IsCellHidden = [this, CellsPerChunk, NumCells, NumChunks](int32 X, int32 Y)
+	{
+		if (X < 1 || Y < 1 || X >= NumCells - 1 || Y >= NumCells - 1)
+		{
+			return false;
+		}
+
+		for (int32 ChunkY = (Y - 1) / CellsPerChunk; ChunkY <= (Y + 1) / CellsPerChunk; ChunkY++)
+		{
+			for (int32 ChunkX = (X - 1) / CellsPerChunk; ChunkX <= (X + 1) / CellsPerChunk; ChunkX++)
+			{
+				if (!Coverage[ChunkX + ChunkY * NumChunks])
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	Triangles.Reset(NumCells * NumCells * 6);
+	for (int32 Y = 0; Y < NumCells; Y++)
+	{
+		for (int32 X = 0; X < NumCells; X++)
+		{
+			if (IsCellHidden(X, Y))
+			{
+				continue;
+			}
+
+			// Même ordre que GenerateOptimizedIndices
+			const int32 Vertex = X + Y * NumPoints;
+			Triangles.Add(Vertex);
+			Triangles.Add(Vertex + NumPoints);
+			Triangles.Add(Vertex + 1);
+			Triangles.Add(Vertex + 1);
+			Triangles.Add(Vertex + NumPoints);
+			Triangles.Add(Vertex + NumPoints + 1);
+		}
+	}
+}
+
+int32 FTerrainFarField::Wrap(int32 GlobalIndex) const
+{
+	return ((GlobalIndex % NumPoints) + NumPoints) % NumPoints;
+}
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+
+/**
+ * Anneau basse résolution autour de la fenêtre des chunks, pour l'horizon.
+ *
+ * Les hauteurs sont gardées dans un tampon torique indexé par coordonnée globale (façon clipmap) :
+ * quand le centre se déplace, seules les lignes et colonnes qui entrent dans la fenêtre sont
+ * échantillonnées. Le trou suit les chunks réellement affichés, de toutes les sources : les
+ * triangles ne sont reconstruits que lorsque cette couverture change.
+ */
+class GP_MODULE_API FTerrainFarField
+{
+public:
+	struct FSettings
+	{
+		int32 ChunkSize = 0;
+		int32 Radius = 0;         // Rayon de l'anneau, en chunks
+		int32 CellsPerChunk = 1;
+		float Scale = 1.0f;
+		float UVScale = 1.0f;
+		float ZMultiplier = 1.0f;
+		float Sink = 0.0f;        // Abaissement pour passer sous les chunks proches
+	};
+
+	// Retourne le nombre d'échantillons de bruit calculés pour cette mise à jour.
+	// IsChunkCovered indique les chunks proches déjà affichés, sous lesquels l'anneau est troué.
+	int32 Update(
+		const FIntPoint& CenterChunk,
+		const FSettings& Settings,
+		TFunctionRef<float(float, float)> SampleHeight,
+		TFunctionRef<bool(const FIntPoint&)> IsChunkCovered
+	);
+
+	// Écart maximal (unités du bruit) entre un bruit à une octave de fréquence SampleFrequency (cycles par
+	// échantillon) et son interpolation linéaire à un pas de Step échantillons
+	static float EstimateInterpolationError(float Step, float SampleFrequency);
+
+	// Oublie les hauteurs (le bruit a changé)
+	void Reset();
+
+	// Position monde du premier vertex de la grille
+	FVector GetOrigin() const;
+
+	bool HasTopologyChanged() const { return bTopologyChanged; }
+	int32 GetNumVertices() const { return Vertices.Num(); }
+
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+	TArray<FProcMeshTangent> Tangents;
+
+private:
+	TArray<float> Heights;
+	TBitArray<> Coverage;     // Un bit par chunk de la grille, au dernier BuildTriangles
+	FSettings AppliedSettings;
+	FIntPoint AppliedOrigin = FIntPoint::ZeroValue;
+	int32 NumPoints = 0;
+	bool bHasSamples = false;
+	bool bTopologyChanged = false;
+
+	void BuildTriangles();
+	int32 Wrap(int32 GlobalIndex) const;
+};
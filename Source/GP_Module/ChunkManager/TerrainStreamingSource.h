@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TerrainStreamingSource.generated.h"
+
+// Point autour duquel le terrain est chargé (joueur, caméra, spectateur, point fixe...)
+USTRUCT(BlueprintType)
+struct GP_MODULE_API FTerrainStreamingSource
+{
+	GENERATED_BODY()
+
+	// Acteur suivi ; pour un PlayerController on suit son pawn, son spectateur ou sa caméra.
+	// Si l'acteur est détruit, la source est retirée automatiquement.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	TWeakObjectPtr<AActor> Actor;
+
+	// Position utilisée quand aucun acteur n'est suivi
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	FVector Location = FVector::ZeroVector;
+
+	// Rayon en chunks ; négatif pour utiliser le RenderDistance du manager
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	int32 RenderDistance = -1;
+
+	// Poids de la source : à priorité 2, un chunk à distance 4 passe avant un chunk à distance 3 d'une source de priorité 1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming", Meta = (ClampMin = 0.01))
+	float Priority = 1.0f;
+};
@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TerrainTraversalReplay.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FString FTerrainTraversalTrace::GetTracePath(const FString& Name)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TerrainTraces"), Name + TEXT(".csv"));
+}
+
+bool FTerrainTraversalTrace::SaveToFile(const FString& Path) const
+{
+	TArray<FString> Lines;
+	Lines.Reserve(Samples.Num() + 1);
+	Lines.Add(TEXT("Time,X,Y,Z"));
+
+	for (const FTerrainTraversalSample& Sample : Samples)
+	{
+		Lines.Add(FString::Printf(TEXT("%.6f,%.3f,%.3f,%.3f"),
+			Sample.Time, Sample.Location.X, Sample.Location.Y, Sample.Location.Z));
+	}
+
+	return FFileHelper::SaveStringArrayToFile(Lines, *Path);
+}
+
+bool FTerrainTraversalTrace::LoadFromFile(const FString& Path)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+	{
+		return false;
+	}
+
+	Samples.Reset(Lines.Num());
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); LineIndex++)
+	{
+		TArray<FString> Fields;
+		if (Lines[LineIndex].ParseIntoArray(Fields, TEXT(",")) != 4)
+		{
+			continue;
+		}
+
+		FTerrainTraversalSample& Sample = Samples.AddDefaulted_GetRef();
+		Sample.Time = FCString::Atod(*Fields[0]);
+		Sample.Location = FVector(FCString::Atod(*Fields[1]), FCString::Atod(*Fields[2]), FCString::Atod(*Fields[3]));
+	}
+
+	return Samples.Num() > 0;
+}
+
+double FTerrainTraversalTrace::GetDuration() const
+{
+	return Samples.Num() > 0 ? Samples.Last().Time : 0.0;
+}
+
+FVector FTerrainTraversalTrace::Evaluate(double Time) const
+{
+	if (Samples.Num() == 0)
+	{
+		return FVector::ZeroVector;
+	}
+
+	// Premier échantillon dont le temps dépasse Time
+	const int32 Next = Algo::UpperBoundBy(Samples, Time, &FTerrainTraversalSample::Time);
+	if (Next == 0)
+	{
+		return Samples[0].Location;
+	}
+	if (Next >= Samples.Num())
+	{
+		return Samples.Last().Location;
+	}
+
+	const FTerrainTraversalSample& A = Samples[Next - 1];
+	const FTerrainTraversalSample& B = Samples[Next];
+	const double Alpha = B.Time > A.Time ? (Time - A.Time) / (B.Time - A.Time) : 0.0;
+	return FMath::Lerp(A.Location, B.Location, Alpha);
+}
+
+void FTerrainReplayStats::Reset(const TArray<float>& InHitchThresholdsMs)
+{
+	TerrainFrameMs.Reset();
+	FrameMs.Reset();
+	HitchThresholdsMs = InHitchThresholdsMs;
+	HitchThresholdsMs.Sort();
+	ChunksBuilt = 0;
+	MaxResidentChunks = 0;
+	GarbageCollections = 0;
+	MaxUsedPhysical = 0;
+}
+
+void FTerrainReplayStats::AddFrame(double TerrainMs, double InFrameMs, int32 InChunksBuilt, int32 ResidentChunks)
+{
+	TerrainFrameMs.Add(TerrainMs);
+	FrameMs.Add(InFrameMs);
+	ChunksBuilt += InChunksBuilt;
+	MaxResidentChunks = FMath::Max(MaxResidentChunks, ResidentChunks);
+	MaxUsedPhysical = FMath::Max(MaxUsedPhysical, static_cast<uint64>(FPlatformMemory::GetStats().UsedPhysical));
+}
+
+FString FTerrainReplayStats::BuildReport(const TArray<TPair<FString, FString>>& Config) const
+{
+	auto Percentile = [](TArray<double> Values, double Fraction)
+	{
+		if (Values.Num() == 0)
+		{
+			return 0.0;
+		}
+		Values.Sort();
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Values.Num()) - 1, 0, Values.Num() - 1);
+		return Values[Index];
+	};
+
+	auto Mean = [](const TArray<double>& Values)
+	{
+		double Sum = 0.0;
+		for (double Value : Values)
+		{
+			Sum += Value;
+		}
+		return Values.Num() > 0 ? Sum / Values.Num() : 0.0;
+	};
+
+	auto CountAbove = [](const TArray<double>& Values, float Threshold)
+	{
+		int32 Count = 0;
+		for (double Value : Values)
+		{
+			Count += Value > Threshold ? 1 : 0;
+		}
+		return Count;
+	};
+
+	// Une clé par ligne, toujours dans le même ordre, pour un diff lisible
+	FString Report = TEXT("[Config]\n");
+	for (const TPair<FString, FString>& Entry : Config)
+	{
+		Report += FString::Printf(TEXT("%s=%s\n"), *Entry.Key, *Entry.Value);
+	}
+
+	Report += TEXT("\n[Results]\n");
+	Report += FString::Printf(TEXT("Frames=%d\n"), TerrainFrameMs.Num());
+	Report += FString::Printf(TEXT("TerrainMsMean=%.3f\n"), Mean(TerrainFrameMs));
+	Report += FString::Printf(TEXT("TerrainMsP50=%.3f\n"), Percentile(TerrainFrameMs, 0.50));
+	Report += FString::Printf(TEXT("TerrainMsP95=%.3f\n"), Percentile(TerrainFrameMs, 0.95));
+	Report += FString::Printf(TEXT("TerrainMsP99=%.3f\n"), Percentile(TerrainFrameMs, 0.99));
+	Report += FString::Printf(TEXT("TerrainMsMax=%.3f\n"), Percentile(TerrainFrameMs, 1.0));
+	Report += FString::Printf(TEXT("FrameMsMean=%.3f\n"), Mean(FrameMs));
+	Report += FString::Printf(TEXT("FrameMsP99=%.3f\n"), Percentile(FrameMs, 0.99));
+	Report += FString::Printf(TEXT("FrameMsMax=%.3f\n"), Percentile(FrameMs, 1.0));
+
+	for (float Threshold : HitchThresholdsMs)
+	{
+		Report += FString::Printf(TEXT("TerrainHitchesOver%gms=%d\n"), Threshold, CountAbove(TerrainFrameMs, Threshold));
+		Report += FString::Printf(TEXT("FrameHitchesOver%gms=%d\n"), Threshold, CountAbove(FrameMs, Threshold));
+	}
+
+	Report += FString::Printf(TEXT("ChunksBuilt=%d\n"), ChunksBuilt);
+	Report += FString::Printf(TEXT("MaxResidentChunks=%d\n"), MaxResidentChunks);
+	Report += FString::Printf(TEXT("GarbageCollections=%d\n"), GarbageCollections);
+	Report += FString::Printf(TEXT("MaxUsedPhysicalMB=%.1f\n"), MaxUsedPhysical / (1024.0 * 1024.0));
+	Report += FString::Printf(TEXT("PeakUsedPhysicalMB=%.1f\n"), FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0));
+
+	return Report;
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTerrainTraversalSample
+{
+	double Time = 0.0;
+	FVector Location = FVector::ZeroVector;
+};
+
+// Trajet enregistré d'un pawn, sauvegardé en CSV dans Saved/TerrainTraces
+struct GP_MODULE_API FTerrainTraversalTrace
+{
+	TArray<FTerrainTraversalSample> Samples;
+
+	static FString GetTracePath(const FString& Name);
+
+	bool SaveToFile(const FString& Path) const;
+	bool LoadFromFile(const FString& Path);
+
+	double GetDuration() const;
+
+	// Interpolation linéaire entre les deux échantillons qui encadrent Time
+	FVector Evaluate(double Time) const;
+};
+
+// Statistiques par frame d'un rejeu, résumées dans un rapport texte stable pour être comparé entre builds
+class GP_MODULE_API FTerrainReplayStats
+{
+public:
+	void Reset(const TArray<float>& InHitchThresholdsMs);
+	void AddFrame(double TerrainMs, double FrameMs, int32 ChunksBuilt, int32 ResidentChunks);
+	void AddGarbageCollection() { GarbageCollections++; }
+
+	// Config : paires clé/valeur écrites telles quelles en tête du rapport
+	FString BuildReport(const TArray<TPair<FString, FString>>& Config) const;
+
+	int32 GetNumFrames() const { return TerrainFrameMs.Num(); }
+
+private:
+	TArray<double> TerrainFrameMs;
+	TArray<double> FrameMs;
+	TArray<float> HitchThresholdsMs;
+	int32 ChunksBuilt = 0;
+	int32 MaxResidentChunks = 0;
+	int32 GarbageCollections = 0;
+	uint64 MaxUsedPhysical = 0;
+};
@@ -4,6 +4,150 @@
 #include "GP_DiamondSquare.h"
 #include "FastNoiseWrapper.h"
 #include "KismetProceduralMeshLibrary.h"
+#include "UObject/ObjectSaveContext.h"
+
+#if WITH_EDITOR
+// Paramètres dont dépend le bruit échantillonné : s'ils ne changent pas, la preview le réutilise
+struct FDiamondSquarePreviewKey
+{
+	int32 XSize = 0;
+	int32 YSize = 0;
+	int32 Seed = 0;
+	float Frequency = 0.0f;
+	float NoiseScale = 0.0f;
+
+	bool operator==(const FDiamondSquarePreviewKey& Other) const
+	{
+		return XSize == Other.XSize && YSize == Other.YSize && Seed == Other.Seed
+			&& Frequency == Other.Frequency && NoiseScale == Other.NoiseScale;
+	}
+};
+
+struct FDiamondSquarePreviewMesh
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector2D> UVs;
+	TArray<FVector> Normals;
+	TArray<FProcMeshTangent> Tangents;
+};
+
+struct FDiamondSquarePreviewJob : public FTerrainNoiseJob
+{
+	FDiamondSquarePreviewKey Key;
+	float ZMultiplier = 1.0f;
+	float fScale = 1.0f;
+	float fUVScale = 1.0f;
+	int32 CoarseStep = 1;
+
+	// Bruit brut (avant ZMultiplier), rempli au fil des passes et repris par le job suivant
+	TArray<float> NoiseValues;
+	TBitArray<> Sampled;
+	int32 NumSampled = 0;
+
+	// Dernière passe terminée, pas encore envoyée au mesh
+	FCriticalSection ResultLock;
+	TOptional<FDiamondSquarePreviewMesh> Result;
+};
+
+namespace DiamondSquarePreview
+{
+	static void Run(FDiamondSquarePreviewJob& Job)
+	{
+		const int32 XSize = Job.Key.XSize;
+		const int32 YSize = Job.Key.YSize;
+		const int32 NumPoints = (XSize + 1) * (YSize + 1);
+
+		if (Job.NoiseValues.Num() != NumPoints)
+		{
+			Job.NoiseValues.SetNumUninitialized(NumPoints);
+			Job.Sampled.Init(false, NumPoints);
+			Job.NumSampled = 0;
+		}
+
+		// Si tout le bruit est déjà connu (ex. seul ZMultiplier a changé), pas de passe grossière
+		int32 Step = Job.NumSampled == NumPoints ? 1 : Job.CoarseStep;
+
+		TArray<int32> Xs;
+		TArray<int32> Ys;
+		while (!Job.bCancelled)
+		{
+			TerrainGrid::BuildAxis(XSize, Step, Xs);
+			TerrainGrid::BuildAxis(YSize, Step, Ys);
+
+			// Les points des passes précédentes sont réutilisés
+			for (int32 X : Xs)
+			{
+				if (Job.bCancelled)
+				{
+					break;
+				}
+
+				for (int32 Y : Ys)
+				{
+					const int32 Index = Y + X * (YSize + 1);
+					if (!Job.Sampled[Index])
+					{
+						Job.NoiseValues[Index] = Job.SampleNoise(X, Y);
+						Job.Sampled[Index] = true;
+						Job.NumSampled++;
+					}
+				}
+			}
+
+			if (Job.bCancelled)
+			{
+				break;
+			}
+
+			// Même disposition que CreateVertices/CreateTriangles, sur la grille réduite
+			FDiamondSquarePreviewMesh Mesh;
+			const int32 NumX = Xs.Num();
+			const int32 NumY = Ys.Num();
+			Mesh.Vertices.Reserve(NumX * NumY);
+			Mesh.UVs.Reserve(NumX * NumY);
+			Mesh.Triangles.Reserve((NumX - 1) * (NumY - 1) * 6);
+
+			for (int32 X : Xs)
+			{
+				for (int32 Y : Ys)
+				{
+					const float Height = Job.NoiseValues[Y + X * (YSize + 1)] * Job.ZMultiplier;
+					Mesh.Vertices.Add(FVector(X * Job.fScale, Y * Job.fScale, Height));
+					Mesh.UVs.Add(FVector2D(X * Job.fUVScale, Y * Job.fUVScale));
+				}
+			}
+
+			for (int32 IX = 0; IX < NumX - 1; ++IX)
+			{
+				for (int32 IY = 0; IY < NumY - 1; ++IY)
+				{
+					const int32 Vertex = IY + IX * NumY;
+					Mesh.Triangles.Add(Vertex);
+					Mesh.Triangles.Add(Vertex + 1);
+					Mesh.Triangles.Add(Vertex + NumY);
+					Mesh.Triangles.Add(Vertex + 1);
+					Mesh.Triangles.Add(Vertex + NumY + 1);
+					Mesh.Triangles.Add(Vertex + NumY);
+				}
+			}
+
+			UKismetProceduralMeshLibrary::CalculateTangentsForMesh(Mesh.Vertices, Mesh.Triangles, Mesh.UVs, Mesh.Normals, Mesh.Tangents);
+
+			{
+				FScopeLock Lock(&Job.ResultLock);
+				Job.Result = MoveTemp(Mesh);
+			}
+
+			if (Step == 1)
+			{
+				break;
+			}
+			Step /= 2;
+		}
+	}
+}
+#endif
 
 AGP_DiamondSquare::AGP_DiamondSquare()
 {
@@ -18,7 +162,20 @@ void AGP_DiamondSquare::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	NoiseGenerator->SetupFastNoise(
+	ConfigureNoise(NoiseGenerator);
+
+	CreateVertices();
+	CreateTriangles();
+	
+	UKismetProceduralMeshLibrary::CalculateTangentsForMesh(Vertices, Triangles, UVs, Normals, Tangents);
+	
+	ProceduralMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, TArray<FColor>(), Tangents, true);
+	ProceduralMesh->SetMaterial(0, Material);
+}
+
+void AGP_DiamondSquare::ConfigureNoise(UFastNoiseWrapper* Noise) const
+{
+	Noise->SetupFastNoise(
 		EFastNoise_NoiseType::Perlin,    // NoiseType
 		Seed,                            // Seed
 		Frequency,                       // Frequency
@@ -31,20 +188,197 @@ void AGP_DiamondSquare::BeginPlay()
 		EFastNoise_CellularDistanceFunction::Euclidean, // CellularDistanceFunction
 		EFastNoise_CellularReturnType::Distance // CellularReturnType
 	);
-
-	CreateVertices();
-	CreateTriangles();
-	
-	UKismetProceduralMeshLibrary::CalculateTangentsForMesh(Vertices, Triangles, UVs, Normals, Tangents);
-	
-	ProceduralMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, TArray<FColor>(), Tangents, true);
-	ProceduralMesh->SetMaterial(0, Material);
 }
 
 void AGP_DiamondSquare::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+#if WITH_EDITOR
+	if (!GetWorld()->IsGameWorld())
+	{
+		UpdatePreview(DeltaTime);
+	}
+#endif
+}
+
+bool AGP_DiamondSquare::ShouldTickIfViewportsOnly() const
+{
+#if WITH_EDITOR
+	// Sans Play, seul le Tick des viewports fait avancer les passes de la preview
+	if (bEditorPreview && GetWorld() && !GetWorld()->IsGameWorld())
+	{
+		return true;
+	}
+#endif
+	return Super::ShouldTickIfViewportsOnly();
+}
+
+#if WITH_EDITOR
+void AGP_DiamondSquare::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	// Première preview à la pose ou au chargement ; les déplacements ne changent pas le mesh
+	if (!bPreviewBuilt && GetWorld() && !GetWorld()->IsGameWorld())
+	{
+		RequestPreview();
+	}
+}
+
+void AGP_DiamondSquare::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (GetWorld() && GetWorld()->IsGameWorld())
+	{
+		return;
+	}
+
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(AGP_DiamondSquare, Material))
+	{
+		ProceduralMesh->SetMaterial(0, Material);
+		return;
+	}
+
+	if (bEditorPreview)
+	{
+		RequestPreview();
+	}
+	else if (PreviewJob)
+	{
+		PreviewJob->bCancelled = true;
+		bPreviewPending = false;
+	}
+}
+
+void AGP_DiamondSquare::BeginDestroy()
+{
+	PreviewJobs.CancelAll();
+
+	Super::BeginDestroy();
+}
+
+void AGP_DiamondSquare::PreSave(FObjectPreSaveContext SaveContext)
+{
+	// Les sections de preview ne doivent pas finir dans la map : BeginPlay reconstruit le mesh
+	if (!IsTemplate() && bPreviewBuilt)
+	{
+		ProceduralMesh->ClearAllMeshSections();
+		bPreviewBuilt = false;
+
+		if (bEditorPreview && GetWorld() && !GetWorld()->IsGameWorld())
+		{
+			RequestPreview();
+		}
+	}
+
+	Super::PreSave(SaveContext);
+}
+
+bool AGP_DiamondSquare::IsReadyForFinishDestroy()
+{
+	return !PreviewJobs.HasUnfinishedJobs() && Super::IsReadyForFinishDestroy();
+}
+
+void AGP_DiamondSquare::RequestPreview()
+{
+	// Le résultat du job en cours est déjà périmé
+	if (PreviewJob)
+	{
+		PreviewJob->bCancelled = true;
+	}
+
+	bPreviewPending = true;
+	PreviewDebounceRemaining = PreviewDebounceSeconds;
+}
+
+void AGP_DiamondSquare::StartPreviewJob()
+{
+	TSharedPtr<FDiamondSquarePreviewJob> Job = MakeShared<FDiamondSquarePreviewJob>();
+	Job->Key.XSize = iXSize;
+	Job->Key.YSize = iYSize;
+	Job->Key.Seed = Seed;
+	Job->Key.Frequency = Frequency;
+	Job->Key.NoiseScale = NoiseScale;
+	Job->NoiseScale = NoiseScale;
+	Job->ZMultiplier = ZMultiplier;
+	Job->fScale = fScale;
+	Job->fUVScale = fUVScale;
+	Job->CoarseStep = FMath::RoundUpToPowerOfTwo(FMath::Max(PreviewCoarseStep, 1));
+
+	const bool bPreviousRunning = PreviewJob && !PreviewJob->bFinished;
+	const bool bSameNoise = PreviewJob && PreviewJob->Key == Job->Key;
+
+	if (bSameNoise && !bPreviousRunning)
+	{
+		// Reprendre le bruit déjà échantillonné, même partiellement
+		Job->NoiseValues = MoveTemp(PreviewJob->NoiseValues);
+		Job->Sampled = MoveTemp(PreviewJob->Sampled);
+		Job->NumSampled = PreviewJob->NumSampled;
+	}
+
+	if (!bSameNoise || !PreviewNoiseGenerator)
+	{
+		// On ne reconfigure pas un bruit encore lu par un job, annulé ou non
+		if (PreviewNoiseGenerator && PreviewJobs.IsNoiseInUse(PreviewNoiseGenerator))
+		{
+			RetiredPreviewNoiseGenerators.Add(PreviewNoiseGenerator);
+			PreviewNoiseGenerator = nullptr;
+		}
+		if (!PreviewNoiseGenerator)
+		{
+			PreviewNoiseGenerator = NewObject<UFastNoiseWrapper>(this, NAME_None, RF_Transient);
+		}
+		ConfigureNoise(PreviewNoiseGenerator);
+	}
+	Job->Noise = PreviewNoiseGenerator;
+
+	PreviewJob = Job;
+
+	PreviewJobs.Launch(Job.ToSharedRef(), [Job]()
+	{
+		DiamondSquarePreview::Run(*Job);
+	});
+}
+
+void AGP_DiamondSquare::UpdatePreview(float DeltaTime)
+{
+	if (bPreviewPending)
+	{
+		PreviewDebounceRemaining -= DeltaTime;
+		if (PreviewDebounceRemaining <= 0.0f)
+		{
+			bPreviewPending = false;
+			StartPreviewJob();
+		}
+	}
+
+	if (PreviewJob && !PreviewJob->bCancelled)
+	{
+		TOptional<FDiamondSquarePreviewMesh> Mesh;
+		{
+			FScopeLock Lock(&PreviewJob->ResultLock);
+			Mesh = MoveTemp(PreviewJob->Result);
+			PreviewJob->Result.Reset();
+		}
+
+		if (Mesh.IsSet())
+		{
+			// Collision construite seulement par BeginPlay : sa cuisson bloquerait le game thread à chaque passe
+			ProceduralMesh->CreateMeshSection(0, Mesh->Vertices, Mesh->Triangles, Mesh->Normals, Mesh->UVs, TArray<FColor>(), Mesh->Tangents, false);
+			ProceduralMesh->SetMaterial(0, Material);
+			bPreviewBuilt = true;
+		}
+	}
+
+	if (!PreviewJobs.HasUnfinishedJobs())
+	{
+		RetiredPreviewNoiseGenerators.Empty();
+	}
 }
+#endif
 
 void AGP_DiamondSquare::CreateVertices()
 {
@@ -6,11 +6,13 @@
 #include "GameFramework/Actor.h"
 #include "ProceduralMeshComponent.h"
 #include "FastNoiseWrapper.h"
+#include "ChunkManager/TerrainAsyncJob.h"
 #include "GP_DiamondSquare.generated.h"
 
 class UProceduralMeshComponent;
 class UMaterialInterface;
 class UFastNoiseWrapper;
+struct FDiamondSquarePreviewJob;
 
 UCLASS()
 class GP_MODULE_API AGP_DiamondSquare : public AActor
@@ -42,6 +44,20 @@ class GP_MODULE_API AGP_DiamondSquare : public AActor
 
 	UPROPERTY(EditAnywhere, Category = "Noise Settings")
 	float Frequency = 0.2f;
+
+#if WITH_EDITORONLY_DATA
+	// Régénère le mesh dans l'éditeur quand une propriété change, sans passer par Play
+	UPROPERTY(EditAnywhere, Category = "Preview")
+	bool bEditorPreview = true;
+
+	// Délai sans modification avant de lancer la génération
+	UPROPERTY(EditAnywhere, Category = "Preview", Meta = (ClampMin = 0.0))
+	float PreviewDebounceSeconds = 0.2f;
+
+	// Pas de la première passe grossière, divisé par deux à chaque raffinement
+	UPROPERTY(EditAnywhere, Category = "Preview", Meta = (ClampMin = 1))
+	int32 PreviewCoarseStep = 8;
+#endif
 	
 protected:
 	// Called when the game starts or when spawned
@@ -53,6 +69,15 @@ protected:
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override; 
+	virtual bool ShouldTickIfViewportsOnly() const override;
+
+#if WITH_EDITOR
+	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+	virtual void BeginDestroy() override;
+	virtual bool IsReadyForFinishDestroy() override;
+#endif
 
 	UPROPERTY()
 	UFastNoiseWrapper* NoiseGenerator;
@@ -68,5 +93,27 @@ private:
 	
 	void CreateVertices();
 	void CreateTriangles();
+	void ConfigureNoise(UFastNoiseWrapper* Noise) const;
+
+#if WITH_EDITORONLY_DATA
+	// Bruit utilisé par le job de preview ; les anciens restent en vie jusqu'à la fin de leur job
+	UPROPERTY(Transient)
+	UFastNoiseWrapper* PreviewNoiseGenerator = nullptr;
+
+	UPROPERTY(Transient)
+	TArray<UFastNoiseWrapper*> RetiredPreviewNoiseGenerators;
+
+	TSharedPtr<FDiamondSquarePreviewJob> PreviewJob;
+	FTerrainJobTracker PreviewJobs;
+	float PreviewDebounceRemaining = 0.0f;
+	bool bPreviewPending = false;
+	bool bPreviewBuilt = false;
+#endif
+
+#if WITH_EDITOR
+	void RequestPreview();
+	void StartPreviewJob();
+	void UpdatePreview(float DeltaTime);
+#endif
 
 };